@@ -0,0 +1,362 @@
+#include <engine/Engine.h>
+#include <engine/ECS.h>
+#include <engine/Entity.h>
+#include <engine/Physics.h>
+#include <engine/Pool.h>
+#include <engine/Collision.h>
+#include <engine/Input.h>
+#include <engine/Protocol.h>
+#include <engine/NetworkTypes.h>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// engine_bench: microbenchmarks for the engine hot paths.
+// Usage: engine_bench [--filter <substring>] [--min-time <seconds>] [--out <file.json>]
+// Results are written as JSON (stdout unless --out is given) so runs can be diffed between releases.
+
+namespace {
+	// Results are folded into this so the compiler can't drop the measured work
+	volatile uint64_t g_sink = 0;
+
+	void consume(uint64_t v) {
+		g_sink = g_sink + v;
+	}
+
+	// Entity subclass used to measure typed queries
+	struct Tagged : Entity {
+		Tagged() : Entity(0.0f, 0.0f, 32.0f, 32.0f, nullptr, false, false) {}
+	};
+
+	uint64_t bitsOf(float f) {
+		uint32_t u;
+		std::memcpy(&u, &f, sizeof(u));
+		return u;
+	}
+
+	// Entity counts every scaling benchmark runs with
+	const std::vector<int> kEntityCounts = { 10, 100, 1000, 10000, 100000 };
+
+	struct Options {
+		std::string filter;
+		double minTime = 0.25; // seconds of measurement per benchmark
+		std::string outPath;
+	};
+
+	struct Result {
+		std::string name;
+		int param;          // entity/item count for this run
+		uint64_t iterations;
+		double nsPerIteration;
+		double nsPerItem;
+	};
+
+	/**
+	 * Times a benchmark body until minTime has passed.
+	 * @param body Runs one iteration, which processes `items` items.
+	 * @param items Items processed per iteration, used for the per-item figure.
+	 * @param minTime Seconds to keep measuring for.
+	 */
+	Result measure(const std::string& name, int param, int items, double minTime, const std::function<void()>& body) {
+		using clock = std::chrono::steady_clock;
+
+		// Warm caches and branch predictors
+		body();
+
+		uint64_t iterations = 0;
+		uint64_t batch = 1;
+		double elapsedNS = 0.0;
+		while (elapsedNS < minTime * 1e9) {
+			auto start = clock::now();
+			for (uint64_t i = 0; i < batch; ++i) body();
+			elapsedNS += std::chrono::duration<double, std::nano>(clock::now() - start).count();
+			iterations += batch;
+			// Grow the batch so clock reads stay out of the measurement
+			if (batch < (1u << 20)) batch *= 2;
+		}
+
+		const double perIteration = elapsedNS / static_cast<double>(iterations);
+		return { name, param, iterations, perIteration, perIteration / (items > 0 ? items : 1) };
+	}
+
+	// A world of gravity affected, collidable entities spread over a 1920x1080 area
+	std::vector<std::unique_ptr<Entity>> makeEntities(int count) {
+		std::vector<std::unique_ptr<Entity>> entities;
+		entities.reserve(count);
+		for (int i = 0; i < count; ++i) {
+			const float x = static_cast<float>((i * 37) % 1920);
+			const float y = static_cast<float>((i * 91) % 1080);
+			entities.emplace_back(new Entity(x, y, 64.0f, 64.0f, nullptr, true, true));
+			entities.back()->setVelocity({ {0.6f, -0.8f}, 250.0f });
+		}
+		return entities;
+	}
+
+	// A snapshot with count players and count synced objects
+	WorldSnapshot makeSnapshot(int count) {
+		WorldSnapshot snapshot;
+		snapshot.tick = 12345;
+		for (int i = 0; i < count; ++i) {
+			snapshot.playerIds.push_back(i);
+			snapshot.playerPositions.push_back({ 100.0f + i * 0.25f, 800.5f - i * 0.125f });
+			snapshot.syncedObjects.push_back({ i, i % 3, { 1100.0f + i, 700.0f - i } });
+		}
+		return snapshot;
+	}
+
+	bool selected(const Options& options, const std::string& name) {
+		return options.filter.empty() || name.find(options.filter) != std::string::npos;
+	}
+
+	void runAll(const Options& options, std::vector<Result>& results) {
+		const float dt = 1.0f / 120.0f;
+		int engineEntities = 0;
+		int taggedEntities = 0;
+		int staticEntities = 0;
+
+		for (int count : kEntityCounts) {
+			if (selected(options, "Physics::apply")) {
+				auto entities = makeEntities(count);
+				results.push_back(measure("Physics::apply", count, count, options.minTime, [&]() {
+					for (auto& e : entities) Physics::apply(e.get(), dt);
+					consume(bitsOf(entities.front()->getVelocityComponents().y));
+				}));
+			}
+
+			if (selected(options, "Physics::integrate")) {
+				// Bulk integration over contiguous arrays, for both integrators
+				for (Physics::Integrator integrator : { Physics::Integrator::SemiImplicitEuler, Physics::Integrator::Verlet }) {
+					const bool verlet = integrator == Physics::Integrator::Verlet;
+					BodyBatch batch;
+					batch.resize(count);
+					for (int i = 0; i < count; ++i) {
+						batch.positions[i] = { static_cast<float>((i * 37) % 1920), static_cast<float>((i * 91) % 1080) };
+						batch.velocities[i] = { 150.0f, -200.0f };
+					}
+					Physics::setIntegrator(integrator);
+					results.push_back(measure(verlet ? "Physics::integrate/verlet" : "Physics::integrate/euler", count, count, options.minTime, [&]() {
+						Physics::integrate(batch, Physics::getGravityAcceleration(), dt);
+						consume(bitsOf(batch.positions.front().y));
+					}));
+				}
+				Physics::setIntegrator(Physics::Integrator::SemiImplicitEuler);
+			}
+
+			if (selected(options, "ecs::systems::integrate")) {
+				// Same workload as Entity::update, stored in ECS chunks
+				ecs::World world;
+				for (int i = 0; i < count; ++i) {
+					const float x = static_cast<float>((i * 37) % 1920);
+					const float y = static_cast<float>((i * 91) % 1080);
+					world.create(ecs::Position{ { x, y } }, ecs::Velocity{ { 150.0f, -200.0f } }, ecs::Gravity{});
+				}
+				results.push_back(measure("ecs::systems::integrate", count, count, options.minTime, [&]() {
+					ecs::systems::integrate(world, dt);
+					consume(world.size());
+				}));
+			}
+
+			if (selected(options, "Entity::update")) {
+				auto entities = makeEntities(count);
+				results.push_back(measure("Entity::update", count, count, options.minTime, [&]() {
+					for (auto& e : entities) e->update(dt);
+					consume(bitsOf(entities.front()->getPosition().y));
+				}));
+			}
+
+			if (selected(options, "Collision::checkCollision")) {
+				// One mover tested against the whole world, like a player scanning for platforms
+				auto entities = makeEntities(count);
+				Entity probe(960.0f, 540.0f, 64.0f, 64.0f, nullptr, false, true);
+				results.push_back(measure("Collision::checkCollision", count, count, options.minTime, [&]() {
+					uint64_t hits = 0;
+					for (auto& e : entities) hits += Collision::checkCollision(probe, *e) ? 1 : 0;
+					consume(hits);
+				}));
+			}
+
+			if (selected(options, "Engine::queryStatic")) {
+				// Platforms on a grid, queried with a player sized box like Player::update does
+				for (; staticEntities < count; ++staticEntities) {
+					const float x = static_cast<float>((staticEntities % 1000) * 100);
+					const float y = static_cast<float>((staticEntities / 1000) * 100);
+					Engine::addStaticEntity(new Entity(x, y, 96.0f, 32.0f, nullptr, false, true));
+				}
+				std::vector<Entity*> found;
+				const SDL_FRect area = { 250.0f, 10.0f, 66.0f, 80.0f };
+				results.push_back(measure("Engine::queryStatic", count, 1, options.minTime, [&]() {
+					found.clear();
+					Engine::queryStatic(area, found);
+					consume(found.size());
+				}));
+			}
+
+			if (selected(options, "Protocol::encodeSnapshot")) {
+				const WorldSnapshot snapshot = makeSnapshot(count);
+				results.push_back(measure("Protocol::encodeSnapshot", count, count, options.minTime, [&]() {
+					consume(Protocol::encodeSnapshot(snapshot).size());
+				}));
+			}
+
+			if (selected(options, "Protocol::decodeSnapshot")) {
+				const std::string message = Protocol::encodeSnapshot(makeSnapshot(count));
+				WorldSnapshot out;
+				results.push_back(measure("Protocol::decodeSnapshot", count, count, options.minTime, [&]() {
+					consume(Protocol::decodeSnapshot(message.data(), message.size(), out) ? out.syncedObjects.size() : 0);
+				}));
+			}
+
+			if (selected(options, "Engine::getEntitiesSnapshot")) {
+				// The engine list only grows, and counts run in ascending order
+				for (; engineEntities < count; ++engineEntities) {
+					Engine::addEntity(new Entity(0.0f, 0.0f, 32.0f, 32.0f, nullptr, false, false));
+				}
+				results.push_back(measure("Engine::getEntitiesSnapshot", count, count, options.minTime, [&]() {
+					consume(Engine::getEntitiesSnapshot().size());
+				}));
+			}
+
+			if (selected(options, "Engine::each")) {
+				// One in sixteen of the queried type next to count untyped entities, so cost should track matches only
+				for (; engineEntities < count; ++engineEntities) {
+					Engine::addEntity(new Entity(0.0f, 0.0f, 32.0f, 32.0f, nullptr, false, false));
+				}
+				for (; taggedEntities < count / 16; ++taggedEntities) {
+					Engine::addEntity(new Tagged());
+				}
+				results.push_back(measure("Engine::each", count, taggedEntities, options.minTime, [&]() {
+					uint64_t n = 0;
+					for (Tagged* t : Engine::each<Tagged>()) n += t->isCollidable();
+					consume(n);
+				}));
+			}
+		}
+
+		if (selected(options, "Pool::create")) {
+			// Spawn/despawn churn through a reserved pool, against new/delete of the same type
+			Pool<Tagged> pool;
+			pool.reserve(1);
+			results.push_back(measure("Pool::create/pooled", 1, 1, options.minTime, [&]() {
+				const Handle<Tagged> h = pool.create();
+				consume(h.generation);
+				pool.destroy(h);
+			}));
+			results.push_back(measure("Pool::create/new", 1, 1, options.minTime, [&]() {
+				Tagged* t = new Tagged();
+				consume(reinterpret_cast<uintptr_t>(t) & 1);
+				delete t;
+			}));
+		}
+
+		if (selected(options, "Input::getActionMask")) {
+			// Parameter is the number of bound actions (up to all 32 bits)
+			for (int bindings : { 5, 32 }) {
+				Input::clearBindings();
+				for (int bit = 0; bit < bindings; ++bit) {
+					Input::bindAction(static_cast<SDL_Scancode>(SDL_SCANCODE_A + bit), static_cast<uint32_t>(bit));
+				}
+				// Hold every other bound key
+				for (int bit = 0; bit < bindings; bit += 2) {
+					SDL_Event down{};
+					down.type = SDL_EVENT_KEY_DOWN;
+					down.key.scancode = static_cast<SDL_Scancode>(SDL_SCANCODE_A + bit);
+					down.key.down = true;
+					Input::processEvent(down);
+				}
+				results.push_back(measure("Input::getActionMask", bindings, 1, options.minTime, [&]() {
+					consume(Input::getActionMask());
+				}));
+			}
+			Input::clearBindings();
+		}
+
+		if (selected(options, "Input::processEvent")) {
+			// One press and release queued then consumed, the per tap cost on the input path
+			Input::clearBindings();
+			Input::bindAction(SDL_SCANCODE_W, 0);
+			SDL_Event down{};
+			down.type = SDL_EVENT_KEY_DOWN;
+			down.key.scancode = SDL_SCANCODE_W;
+			down.key.down = true;
+			SDL_Event up = down;
+			up.type = SDL_EVENT_KEY_UP;
+			up.key.down = false;
+			results.push_back(measure("Input::processEvent", 2, 2, options.minTime, [&]() {
+				Input::processEvent(down);
+				Input::processEvent(up);
+				consume(Input::sampleActions(UINT64_MAX).pressed);
+			}));
+			Input::clearBindings();
+		}
+	}
+
+	void writeJson(std::FILE* out, const std::vector<Result>& results, const Options& options) {
+		std::time_t now = std::time(nullptr);
+		char date[32];
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+		std::fprintf(out, "{\n");
+		std::fprintf(out, "  \"context\": {\n");
+		std::fprintf(out, "    \"date\": \"%s\",\n", date);
+		std::fprintf(out, "    \"min_time_s\": %g,\n", options.minTime);
+#ifdef NDEBUG
+		std::fprintf(out, "    \"build\": \"release\"\n");
+#else
+		std::fprintf(out, "    \"build\": \"debug\"\n");
+#endif
+		std::fprintf(out, "  },\n");
+		std::fprintf(out, "  \"benchmarks\": [\n");
+		for (size_t i = 0; i < results.size(); ++i) {
+			const Result& r = results[i];
+			std::fprintf(out, "    {\"name\": \"%s\", \"param\": %d, \"iterations\": %llu, "
+				"\"ns_per_iteration\": %.3f, \"ns_per_item\": %.3f}%s\n",
+				r.name.c_str(), r.param, static_cast<unsigned long long>(r.iterations),
+				r.nsPerIteration, r.nsPerItem, i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(out, "  ]\n");
+		std::fprintf(out, "}\n");
+	}
+}
+
+int main(int argc, char* argv[]) {
+	Options options;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--filter" && i + 1 < argc) options.filter = argv[++i];
+		else if (arg == "--min-time" && i + 1 < argc) options.minTime = std::atof(argv[++i]);
+		else if (arg == "--out" && i + 1 < argc) options.outPath = argv[++i];
+		else {
+			std::fprintf(stderr, "usage: engine_bench [--filter <substring>] [--min-time <seconds>] [--out <file.json>]\n");
+			return 1;
+		}
+	}
+
+	// Benchmarks only simulate, so no window or renderer is needed
+	Engine::Config config{ "engine_bench", 0, 0, true };
+	if (!Engine::init(config)) return 1;
+
+	std::vector<Result> results;
+	runAll(options, results);
+
+	std::FILE* out = stdout;
+	if (!options.outPath.empty()) {
+		out = std::fopen(options.outPath.c_str(), "w");
+		if (!out) {
+			std::fprintf(stderr, "Couldn't open %s\n", options.outPath.c_str());
+			Engine::shutdown();
+			return 1;
+		}
+	}
+	writeJson(out, results, options);
+	if (out != stdout) std::fclose(out);
+
+	Engine::shutdown();
+	return 0;
+}
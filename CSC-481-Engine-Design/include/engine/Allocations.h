@@ -0,0 +1,81 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// What a heap allocation was made for, taken from the innermost AllocScope on its thread
+enum class AllocTag : uint8_t {
+	General = 0,    // no scope open
+	Engine,         // update thread, entity and system updates
+	Game,           // the game's update callback
+	Render,         // drawing and the render callback
+	Network,        // sending, receiving and decoding
+	Streaming,      // tilemap and asset loading
+	Count
+};
+
+// Allocation count and bytes over some span
+struct AllocStats {
+	uint64_t count = 0;
+	uint64_t bytes = 0;
+};
+
+// The Allocations class counts heap allocations per tag and per main loop frame.
+// Counting needs the ENGINE_TRACK_ALLOCATIONS build option, which replaces the global
+// operator new. Without it every call still works and every count stays 0.
+// With a steady state set, any frame past the warm up that allocates is reported and
+// asserts in debug builds, so allocations sneaking into the frame path show up right away.
+class Allocations {
+public:
+	// True when built with ENGINE_TRACK_ALLOCATIONS
+	static bool isTracking();
+
+	// Close the current frame and start the next, called once per main loop iteration
+	static void nextFrame();
+
+	// Counts of the last finished frame, for one tag or all of them
+	static AllocStats lastFrame(AllocTag tag);
+	static AllocStats lastFrameTotal();
+
+	// Counts since startup
+	static AllocStats total(AllocTag tag);
+
+	// Main loop frames finished so far
+	static uint64_t frameCount();
+
+	// Expect zero allocations per frame once warmupFrames more frames have run, 0 turns it off
+	static void setSteadyStateAfter(uint64_t warmupFrames);
+
+	static const char* tagName(AllocTag tag);
+
+	// Tag allocations on the calling thread are charged to
+	static AllocTag currentTag();
+
+	// Count one allocation on the calling thread, the operator new hook
+	static void record(size_t bytes);
+
+private:
+	friend class AllocScope;
+	static constexpr int kTags = static_cast<int>(AllocTag::Count);
+
+	static thread_local AllocTag t_tag;
+	static std::atomic<uint64_t> s_frameCount[kTags];
+	static std::atomic<uint64_t> s_frameBytes[kTags];
+	static std::atomic<uint64_t> s_totalCount[kTags];
+	static std::atomic<uint64_t> s_totalBytes[kTags];
+	static AllocStats s_lastFrame[kTags];
+	static uint64_t s_frames;
+	static uint64_t s_steadyFrom; // first frame expected not to allocate, 0 for never
+};
+
+// Charges the calling thread's allocations to a tag until it goes out of scope (scopes nest)
+class AllocScope {
+public:
+	explicit AllocScope(AllocTag tag) : previous(Allocations::t_tag) { Allocations::t_tag = tag; }
+	~AllocScope() { Allocations::t_tag = previous; }
+	AllocScope(const AllocScope&) = delete;
+	AllocScope& operator=(const AllocScope&) = delete;
+private:
+	AllocTag previous;
+};
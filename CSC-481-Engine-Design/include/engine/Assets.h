@@ -0,0 +1,107 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <engine/MappedFile.h>
+
+// Asset pack layout, read straight from the mapping (little endian):
+//   AssetPackHeader
+//   AssetPackEntry entries[entryCount]
+//   pixel and glyph data, each block on an 8 byte boundary
+// Pixels are SDL_PIXELFORMAT_RGBA32 rows of width * 4 bytes, ready for SDL_UpdateTexture.
+// asset_pack writes these from a manifest.
+struct AssetPackHeader {
+	char magic[8];          // "CSCPACK"
+	uint32_t version;
+	uint32_t entryCount;
+	uint64_t entriesOffset;
+};
+
+struct AssetPackEntry {
+	enum Type : uint32_t {
+		Texture = 0,
+		Font = 1,           // pixels are the glyph atlas, white with coverage in alpha
+	};
+
+	char name[64];          // lookup key, the path the game loads it by (e.g. "assets/Brick.png")
+	uint32_t type;
+	uint32_t width;
+	uint32_t height;
+	uint32_t firstGlyph;    // fonts: codepoint of glyphs[0]
+	uint32_t glyphCount;
+	int32_t lineHeight;
+	uint64_t pixelsOffset;
+	uint64_t glyphsOffset;
+};
+
+// Where one glyph sits in a font atlas and how far it moves the pen
+struct AssetGlyph {
+	uint16_t x, y, w, h;
+	int16_t advance;
+	int16_t reserved;
+};
+
+// A font atlas uploaded from the pack
+struct AssetFont {
+	SDL_Texture* atlas = nullptr;
+	uint32_t firstGlyph = 0;
+	std::vector<AssetGlyph> glyphs;
+	int lineHeight = 0;
+};
+
+// The Assets class loads textures and fonts for the renderer.
+// With a pack open, textures are uploaded straight from its pre-decoded pixels, so nothing is
+// decoded at runtime. Paths missing from the pack still load through SDL_image.
+// Textures are shared: every acquire of the same path returns the same texture, which is
+// destroyed once the last user releases it.
+class Assets {
+public:
+	static constexpr uint32_t kPackVersion = 1;
+
+	// Map a pack built by asset_pack, returns false if it can't be mapped or isn't a pack
+	static bool openPack(const std::string& path);
+
+	// Unmap the pack, textures already uploaded stay valid
+	static void closePack();
+
+	// Shared texture for a path, null if it can't be loaded. Main thread only.
+	static SDL_Texture* acquireTexture(const char* path);
+
+	// Drop one reference taken by acquireTexture
+	static void releaseTexture(SDL_Texture* texture);
+
+	// Font atlas from the pack by name, uploaded on first use. Null if the pack has no such font.
+	static const AssetFont* getFont(const std::string& name);
+
+	// Draw a line of text from a font atlas with its top left corner at x, y
+	static void drawText(SDL_Renderer* renderer, const AssetFont* font, std::string_view text,
+		float x, float y, SDL_Color color);
+
+	// Destroy every texture and font atlas, call before the renderer is destroyed
+	static void clear();
+
+private:
+	struct CachedTexture {
+		SDL_Texture* texture = nullptr;
+		int refs = 0;
+	};
+
+	static const AssetPackEntry* findEntry(const std::string& name, uint32_t type);
+	static SDL_Texture* upload(SDL_Renderer* renderer, const AssetPackEntry& entry);
+
+	static MappedFile s_pack;
+	static const AssetPackEntry* s_entries;
+	static uint32_t s_entryCount;
+	static std::unordered_map<std::string, uint32_t> s_index;
+
+	static std::unordered_map<std::string, CachedTexture> s_textures;
+	static std::string s_textureKey; // reused under s_mutex so finding a cached texture doesn't allocate
+	static std::unordered_map<SDL_Texture*, std::string> s_texturePaths;
+	static std::unordered_map<std::string, AssetFont> s_fonts;
+	static std::mutex s_mutex;
+};
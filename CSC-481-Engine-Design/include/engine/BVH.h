@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <vector>
+
+class Entity;
+
+// The BVH class is a bounding volume hierarchy over entities that don't move.
+// It is built in one pass and then only read, so queries need no per-frame upkeep.
+class BVH {
+public:
+	// Build the tree over the given entities, replacing any previous tree
+	void build(const std::vector<Entity*>& entities);
+
+	// Remove every entity from the tree
+	void clear();
+
+	// Append every entity whose rect overlaps area to out
+	void query(const SDL_FRect& area, std::vector<Entity*>& out) const;
+
+	// Number of entities in the tree
+	size_t size() const;
+
+private:
+	// Axis aligned box stored as min/max corners
+	struct Bounds {
+		float minX, minY, maxX, maxY;
+	};
+
+	// Inner nodes point at two children, leaves at a run of items
+	struct Node {
+		Bounds bounds;
+		int32_t left;  // first child index for inner nodes, -1 for leaves
+		int32_t right; // second child index for inner nodes
+		int32_t first; // first item for leaves
+		int32_t count; // item count for leaves
+	};
+
+	int32_t buildRange(int32_t first, int32_t count);
+
+	std::vector<Node> nodes;
+	std::vector<Entity*> items;
+	std::vector<Bounds> itemBounds;
+
+	static constexpr int32_t kLeafSize = 4;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <engine/Types.h>
+
+// The Camera class maps world coordinates to the screen.
+// At zoom 1 the design size (the world area the game was laid out for) is fit into the
+// output, so a 1920x1080 layout shows whole in a 1900x1000 window instead of being cut off.
+// The view can be kept inside level bounds, and isVisible() lets the renderer skip
+// anything off screen. Used from the main thread.
+class Camera {
+public:
+	Camera() = default;
+
+	// Output size in pixels, the engine sets this every frame
+	void setViewport(float w, float h);
+
+	// World size fit into the viewport at zoom 1
+	void setDesignSize(float w, float h);
+
+	// World point at the middle of the screen
+	void setCenter(OrderedPair center);
+	OrderedPair getCenter() const;
+
+	// Extra magnification on top of the fit scale, clamped between 0.1 and 10
+	void setZoom(float zoom);
+	float getZoom() const;
+
+	// Keep the view inside this world area, centered on it when the view is larger
+	void setBounds(const SDL_FRect& bounds);
+	void clearBounds();
+
+	// Screen pixels per world unit
+	float getScale() const;
+
+	// World area on screen
+	SDL_FRect getView() const;
+
+	// World to screen and back
+	OrderedPair worldToScreen(OrderedPair p) const;
+	SDL_FRect worldToScreen(const SDL_FRect& r) const;
+	OrderedPair screenToWorld(OrderedPair p) const;
+
+	// True if any part of a world rect is on screen
+	bool isVisible(const SDL_FRect& r) const;
+
+private:
+	float viewportW = 1920.0f;
+	float viewportH = 1080.0f;
+	float designW = 1920.0f;
+	float designH = 1080.0f;
+	OrderedPair center{ 960.0f, 540.0f };
+	float zoom = 1.0f;
+	SDL_FRect bounds{};
+	bool bounded = false;
+};
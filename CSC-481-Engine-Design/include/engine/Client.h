@@ -1,33 +1,59 @@
-#pragma once
-#include <zmq.hpp>
-#include <string>
-#include "NetworkTypes.h"
-
-// ClientNetwork provides a simple wrapper around ZeroMQ REQ/SUB sockets.
-// - REQ is used to send move updates to the server.
-// - SUB is used to receive position updates for all players.
-class Client {
-public:
-    Client();
-    ~Client();
-
-    // Connect to the server (default is localhost)
-    bool connect(const std::string& serverAddress = "tcp://localhost");
-
-    // Send this client's command to the server
-	void sendCommand(const ClientCommand& cmd);
-
-    // Poll for updates from the server (non-blocking)
-    // Returns true if snapshot was received
-    bool pollUpdate(WorldSnapshot& outSnapshot);
-
-    static void setClientID(int id);
-
-private:
-    zmq::context_t context;
-    zmq::socket_t requester;   // REQ socket (send commands, receive server acknowledgement)
-    zmq::socket_t subscriber;  // SUB socket (receive world snapshots)
-    static int clientID;
-
-	bool awaitingReply = false;
-};
+#pragma once
+#include <zmq.hpp>
+#include <string>
+#include "NetworkTypes.h"
+#include "Recorder.h"
+
+// ClientNetwork provides a simple wrapper around ZeroMQ REQ/SUB sockets.
+// - REQ is used to send move updates to the server.
+// - SUB is used to receive position updates for all players.
+class Client {
+public:
+    Client();
+    ~Client();
+
+    // Connect to the server (default is localhost) and join a room. Commands are sent to that
+    // room and only its snapshots are received. Snapshots come from port and commands go to
+    // port + 1, like the server's --port (point it at a netem_proxy to test over a bad link).
+    bool connect(const std::string& serverAddress = "tcp://localhost", int room = 0, int port = 5555);
+
+    // Send this client's command to the server
+	void sendCommand(const ClientCommand& cmd);
+
+    // Poll for updates from the server (non-blocking)
+    // Returns true if snapshot was received
+    bool pollUpdate(WorldSnapshot& outSnapshot);
+
+    // Wait up to timeoutMs for the next snapshot, sleeping in zmq::poll instead of spinning.
+    // Replays are held to their recorded timing. Returns true if a snapshot was received.
+    bool waitForUpdate(WorldSnapshot& outSnapshot, int timeoutMs);
+
+    static void setClientID(int id);
+
+    // Record every received snapshot and sent command to a session log
+    bool startRecording(const std::string& path);
+
+    // Feed pollUpdate from a session log instead of the server
+    bool startReplay(const std::string& path);
+    bool isReplaying() const;
+
+private:
+    zmq::context_t context;
+    zmq::socket_t requester;   // REQ socket (send commands, receive server acknowledgement)
+    zmq::socket_t subscriber;  // SUB socket (receive world snapshots)
+    static int clientID;
+
+	bool awaitingReply = false;
+	uint64_t sentAtNS = 0;       // when the command awaiting its reply was sent
+	std::string commandAddress;  // kept to reopen REQ when a reply is lost
+	int room = 0;
+	std::string sendBuffer; // reused for every command so sending doesn't allocate
+
+    // Session capture and playback
+    Recorder recorder;
+    Replay replay;
+
+    // Replay pacing: when playback started, and the first snapshot's recorded time
+    uint64_t replayStartNS = 0;
+    uint64_t replayBaseNS = 0;
+};
@@ -1,13 +1,42 @@
-#pragma once
-
-#include <engine/Entity.h>
-
-// The Collision class provides a static function for collision detection.
-// It is a static class as it does not need to store any state.
-class Collision {
-public:
-    // A simple collision check.
-    // This function uses the `getRect()` method from the Entity class
-    // for a clean and efficient collision check.
-    static bool checkCollision(const Entity& a, const Entity& b);
-};
+#pragma once
+
+#include <vector>
+#include <engine/Entity.h>
+
+// Where a swept box first touches another box.
+struct SweepHit {
+    float time = 1.0f;     // fraction of the displacement travelled at first contact, 0 to 1
+    OrderedPair normal{};  // normal of the face that was hit, pointing back at the mover
+    Entity* other = nullptr;
+};
+
+// The Collision class provides a static function for collision detection.
+// It is a static class as it does not need to store any state.
+class Collision {
+public:
+    // A simple collision check.
+    // This function uses the `getRect()` method from the Entity class
+    // for a clean and efficient collision check.
+    static bool checkCollision(const Entity& a, const Entity& b);
+
+    // The same overlap test on plain rects, for solids that aren't entities.
+    static bool checkCollision(const SDL_FRect& a, const SDL_FRect& b);
+
+    // Swept AABB test: moves `moving` by `displacement` and reports the earliest
+    // contact with `target`. Boxes that already overlap at the start are not reported.
+    static bool sweep(const SDL_FRect& moving, OrderedPair displacement, const SDL_FRect& target, SweepHit& outHit);
+
+    // Swept test between two entities, using their current rects.
+    static bool sweep(const Entity& moving, OrderedPair displacement, const Entity& target, SweepHit& outHit);
+
+    // Moves an entity by `displacement`, stopping at the earliest contact with any of
+    // the collidable obstacles and sliding along the surface for the rest of the move.
+    // Velocity into each surface hit is removed. Returns how many contacts were written.
+    static int moveAndCollide(Entity& entity, OrderedPair displacement, const std::vector<Entity*>& obstacles,
+                              SweepHit* outHits, int maxHits);
+
+    // Same as above, also stopping at static solid rects such as tilemap tiles.
+    // Hits on a rect have a null `other`.
+    static int moveAndCollide(Entity& entity, OrderedPair displacement, const std::vector<Entity*>& obstacles,
+                              const std::vector<SDL_FRect>& solids, SweepHit* outHits, int maxHits);
+};
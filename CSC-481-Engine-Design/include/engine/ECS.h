@@ -0,0 +1,261 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <engine/Types.h>
+
+class Entity;
+
+// Archetype based entity component system.
+// Entities with the same set of components share an archetype, and each archetype stores its
+// components in fixed size chunks with one tightly packed array per component type. Systems
+// ask for component types at compile time and walk only the archetypes that have them.
+// Components must be trivially copyable; empty structs act as tags and take no storage.
+namespace ecs {
+
+	// Handle to an ECS entity. The generation catches handles to destroyed entities.
+	struct EntityId {
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0;
+
+		bool operator==(const EntityId& o) const { return index == o.index && generation == o.generation; }
+		bool operator!=(const EntityId& o) const { return !(*this == o); }
+	};
+
+	// Most component types a program can register, each one is a bit in an archetype mask
+	constexpr uint32_t kMaxComponents = 64;
+
+	// Bytes per chunk, every archetype fits as many rows as it can in one
+	constexpr size_t kChunkBytes = 16 * 1024;
+
+	// Size and alignment recorded for every component type
+	struct ComponentInfo {
+		size_t size;
+		size_t align;
+		bool tag;
+	};
+
+	// Registers a component type and returns its id (called once per type through componentId)
+	uint32_t registerComponent(size_t size, size_t align, bool tag);
+	const ComponentInfo& componentInfo(uint32_t id);
+
+	// Compile time component type id, no RTTI involved
+	template<class T>
+	uint32_t componentId() {
+		static_assert(std::is_trivially_copyable<T>::value, "ECS components must be trivially copyable");
+		static const uint32_t id = registerComponent(sizeof(T), alignof(T), std::is_empty<T>::value);
+		return id;
+	}
+
+	// Archetype mask for a set of component types
+	template<class... Cs>
+	uint64_t maskOf() {
+		return (uint64_t{ 0 } | ... | (uint64_t{ 1 } << componentId<Cs>()));
+	}
+
+	// Built in components
+	struct Position { OrderedPair value; };  // top left corner in world space
+	struct Velocity { OrderedPair value; };  // components in px/s
+	struct Size { OrderedPair value; };      // width and height
+	struct Gravity {};                       // tag: falls under Physics gravity
+	struct LegacyLink { Entity* entity; };   // mirrors an Entity object during migration
+
+	// Position and Velocity arrays are handed straight to Physics::integrate as OrderedPair arrays
+	static_assert(sizeof(Position) == sizeof(OrderedPair) && sizeof(Velocity) == sizeof(OrderedPair),
+		"Position and Velocity must stay layout compatible with OrderedPair");
+
+	// One block of rows for an archetype
+	struct Chunk {
+		unsigned char* data = nullptr;
+		uint32_t count = 0;
+	};
+
+	// All entities that have exactly the same components
+	struct Archetype {
+		uint64_t mask = 0;
+		std::vector<uint32_t> components;  // component ids with storage
+		uint32_t offsets[kMaxComponents];  // byte offset of each component array in a chunk
+		uint32_t capacity = 0;             // rows per chunk
+		uint32_t chunkBytes = 0;           // allocation size of each chunk
+		uint32_t size = 0;                 // rows in use across all chunks
+		std::vector<Chunk> chunks;
+	};
+
+	// The World class owns every archetype and the entity records pointing into them.
+	class World {
+	public:
+		World() = default;
+		~World();
+
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		// Create an entity with the given components
+		template<class... Cs>
+		EntityId create(const Cs&... components) {
+			const EntityId id = allocateId();
+			const uint32_t arch = archetypeFor(maskOf<Cs...>());
+			const uint32_t row = appendRow(arch, id.index);
+			(writeComponent(arch, row, components), ...);
+			return id;
+		}
+
+		// Destroy an entity, its handle becomes stale
+		void destroy(EntityId id);
+
+		// True while the handle refers to a live entity
+		bool isAlive(EntityId id) const;
+
+		// Number of live entities
+		size_t size() const;
+
+		// Component access, null if the entity is stale or lacks the component (or it is a tag)
+		template<class T>
+		T* get(EntityId id) {
+			if (!isAlive(id)) return nullptr;
+			const Record& rec = records[id.index];
+			Archetype& a = archetypes[rec.archetype];
+			const uint32_t cid = componentId<T>();
+			if (!(a.mask & (uint64_t{ 1 } << cid)) || std::is_empty<T>::value) return nullptr;
+			return static_cast<T*>(column(a, cid, rec.row));
+		}
+
+		template<class T>
+		bool has(EntityId id) const {
+			if (!isAlive(id)) return false;
+			return (archetypes[records[id.index].archetype].mask & (uint64_t{ 1 } << componentId<T>())) != 0;
+		}
+
+		// Add a component (moves the entity to another archetype), or overwrite it if present
+		template<class T>
+		void add(EntityId id, const T& value = T{}) {
+			if (!isAlive(id)) return;
+			const uint64_t bit = uint64_t{ 1 } << componentId<T>();
+			if (!(archetypes[records[id.index].archetype].mask & bit)) {
+				moveToArchetype(id, archetypes[records[id.index].archetype].mask | bit);
+			}
+			const Record& rec = records[id.index];
+			writeComponent(rec.archetype, rec.row, value);
+		}
+
+		// Remove a component (moves the entity to another archetype)
+		template<class T>
+		void remove(EntityId id) {
+			if (!isAlive(id)) return;
+			const uint64_t bit = uint64_t{ 1 } << componentId<T>();
+			const uint64_t mask = archetypes[records[id.index].archetype].mask;
+			if (mask & bit) moveToArchetype(id, mask & ~bit);
+		}
+
+		// Calls fn(count, Cs*...) once per chunk that has every Cs and none of the `without` mask.
+		// Arrays are packed, so fn can run vectorized kernels over them. Tags are passed as null.
+		template<class... Cs, class Fn>
+		void eachChunk(Fn&& fn, uint64_t without = 0) {
+			const uint64_t need = maskOf<Cs...>();
+			for (Archetype& a : archetypes) {
+				if ((a.mask & need) != need || (a.mask & without) || a.size == 0) continue;
+				for (Chunk& chunk : a.chunks) {
+					if (chunk.count == 0) continue;
+					fn(static_cast<size_t>(chunk.count), columnArray<Cs>(a, chunk)...);
+				}
+			}
+		}
+
+		// Calls fn(Cs&...) for every entity that has every Cs and none of the `without` mask
+		template<class... Cs, class Fn>
+		void each(Fn&& fn, uint64_t without = 0) {
+			eachChunk<Cs...>([&fn](size_t count, Cs*... arrays) {
+				for (size_t i = 0; i < count; ++i) {
+					fn(element(arrays, i)...);
+				}
+			}, without);
+		}
+
+		// Calls fn(EntityId, Cs&...) for every matching entity
+		template<class... Cs, class Fn>
+		void eachWithId(Fn&& fn, uint64_t without = 0) {
+			const uint64_t need = maskOf<Cs...>();
+			for (Archetype& a : archetypes) {
+				if ((a.mask & need) != need || (a.mask & without) || a.size == 0) continue;
+				for (Chunk& chunk : a.chunks) {
+					const uint32_t* indices = reinterpret_cast<const uint32_t*>(chunk.data);
+					for (uint32_t i = 0; i < chunk.count; ++i) {
+						const EntityId id{ indices[i], records[indices[i]].generation };
+						fn(id, element(columnArray<Cs>(a, chunk), i)...);
+					}
+				}
+			}
+		}
+
+	private:
+		// Where an entity's row lives
+		struct Record {
+			uint32_t archetype = 0;
+			uint32_t row = 0;
+			uint32_t generation = 0;
+			bool alive = false;
+		};
+
+		EntityId allocateId();
+		uint32_t archetypeFor(uint64_t mask);
+		uint32_t appendRow(uint32_t archetype, uint32_t entityIndex);
+		void removeRow(uint32_t archetype, uint32_t row);
+		void moveToArchetype(EntityId id, uint64_t mask);
+		void* column(Archetype& a, uint32_t componentId, uint32_t row);
+
+		template<class T>
+		T* columnArray(Archetype& a, Chunk& chunk) {
+			if constexpr (std::is_empty<T>::value) {
+				return nullptr;
+			}
+			else {
+				return reinterpret_cast<T*>(chunk.data + a.offsets[componentId<T>()]);
+			}
+		}
+
+		template<class T>
+		void writeComponent(uint32_t archetype, uint32_t row, const T& value) {
+			if constexpr (!std::is_empty<T>::value) {
+				*static_cast<T*>(column(archetypes[archetype], componentId<T>(), row)) = value;
+			}
+		}
+
+		// Tags have no storage, so every tag reference points at one shared instance
+		template<class T>
+		static T& element(T* array, size_t i) {
+			if constexpr (std::is_empty<T>::value) {
+				static T tag{};
+				return tag;
+			}
+			else {
+				return array[i];
+			}
+		}
+
+		std::vector<Archetype> archetypes;
+		std::unordered_map<uint64_t, uint32_t> archetypeByMask;
+		std::vector<Record> records;
+		std::vector<uint32_t> freeRecords;
+		size_t liveCount = 0;
+	};
+
+	// Built in systems
+	namespace systems {
+		// Integrates every Position + Velocity in bulk; entities tagged Gravity also fall
+		void integrate(World& world, float deltaTime);
+
+		// Copies state from linked Entity objects into their components
+		void pullLegacy(World& world);
+
+		// Writes component state back to linked Entity objects
+		void pushLegacy(World& world);
+	}
+
+	// Creates an ECS entity mirroring an existing Entity object, so its data can be moved
+	// over to systems a piece at a time. The Entity keeps working as before.
+	EntityId adopt(World& world, Entity* entity);
+}
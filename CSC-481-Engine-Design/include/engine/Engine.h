@@ -1,57 +1,308 @@
-#pragma once
-
-#include <SDL3/SDL.h>
-#include <functional>
-#include <vector>
-#include <thread>
-#include <mutex>
-#include <atomic>
-#include <engine/Types.h>
-// Calls the entity class to make it known that it is using it
-class Entity;
-
-// The core engine class. It manages the game loop, window, renderer, and entities.
-class Engine {
-public:
-    // This is the corrected Config struct, nested inside the Engine class.
-    struct Config {
-        const char* title;
-        int width;
-        int height;
-    };
-	// Runs the main game loop.
-	static void run(std::function<void(float)> update, std::function<void(void)> render);
-
-	// Add an entity to the engine.
-	static void addEntity(Entity* entity);
-
-	// Getter for entities, deadlock causing
-	// static const std::vector<Entity*>& getEntities();
-
-	// Safe access: returns a copy/snapshot of the entity list with no lock held by the caller.
-	static std::vector<Entity*> getEntitiesSnapshot();
-
-	// Getters for the renderer.
-	static SDL_Renderer* getRenderer();
-
-    // Initializes the engine
-	static bool init(const Config& cfg);
-
-    // Shuts down the engine and cleans up all resources.
-	static void shutdown();
-
-	// Get the mutex, if needed in game
-	static std::mutex& getEntitiesMutex();
-
-private:
-	// Private members for the engine's core functionality.
-	static SDL_Window* s_window;
-	static SDL_Renderer* s_renderer;
-	static bool s_running;
-	static std::vector<Entity*> s_entities;
-
-	// Multithreading private members
-	static std::thread s_updateThread;
-	static std::mutex  s_entitiesMutex;
-	static std::atomic<bool> s_workerRunning;
-};
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <functional>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <shared_mutex>
+#include <type_traits>
+#include <engine/Types.h>
+#include <engine/BVH.h>
+#include <engine/ECS.h>
+#include <engine/Pool.h>
+#include <engine/Epoch.h>
+#include <engine/Timeline.h>
+#include <engine/FramePacer.h>
+#include <engine/Tilemap.h>
+#include <engine/Camera.h>
+#include <engine/RenderQueue.h>
+#include <engine/Allocations.h>
+#include <engine/FrameArena.h>
+#include <engine/Input.h>
+// Calls the entity class to make it known that it is using it
+class Entity;
+
+// A range over the engine's entities of one type, returned by Engine::each<T>().
+// It iterates a copy of the type's index list taken when it was created, so no lock is
+// held while looping and nested views are fine. Keep it on the stack for the loop only.
+template<class T>
+class EntityView {
+public:
+	class iterator {
+	public:
+		iterator(const std::vector<Entity*>* list, size_t index) : list(list), index(index) {}
+		T* operator*() const { return static_cast<T*>((*list)[index]); }
+		iterator& operator++() { ++index; return *this; }
+		bool operator!=(const iterator& other) const { return index != other.index; }
+	private:
+		const std::vector<Entity*>* list; // indices, not pointers, survive nested views growing the buffer
+		size_t index;
+	};
+
+	EntityView(std::vector<Entity*>& scratch, size_t first) : scratch(scratch), first(first), last(scratch.size()) {}
+	~EntityView() { scratch.resize(first); }
+	EntityView(const EntityView&) = delete;
+	EntityView& operator=(const EntityView&) = delete;
+
+	iterator begin() const { return iterator(&scratch, first); }
+	iterator end() const { return iterator(&scratch, last); }
+	size_t size() const { return last - first; }
+	bool empty() const { return first == last; }
+
+private:
+	std::vector<Entity*>& scratch;
+	size_t first;
+	size_t last;
+};
+
+// The core engine class. It manages the game loop, window, renderer, and entities.
+class Engine {
+public:
+    // This is the corrected Config struct, nested inside the Engine class.
+    struct Config {
+        const char* title;
+        int width;
+        int height;
+        // Run without a window or renderer (servers, bots, benchmarks).
+        // Entities still update, textures are skipped and nothing is drawn.
+        bool headless = false;
+        // Frame rate cap for the main loop, 0 to follow vsync (or 60 when headless). If vsync
+        // can't be turned on, 0 paces to the display's refresh rate instead.
+        int targetFPS = 0;
+        // Block presents to the display refresh
+        bool vsync = true;
+        // Fixed rate of the entity update thread, in Hz
+        int updateRate = 120;
+        // World area the camera fits into the window at zoom 1
+        float viewWidth = 1920.0f;
+        float viewHeight = 1080.0f;
+    };
+	// Runs the main game loop.
+	static void run(std::function<void(float)> update, std::function<void(void)> render);
+
+	// Updates every entity once on the calling thread, without the worker thread.
+	// Lets headless callers drive the simulation at full speed with a fixed dt.
+	static void step(float deltaTime);
+
+	// Asks the main loop to exit after the current iteration.
+	static void stop();
+
+	// Actions the update ticks sampled since the last call: the latest held actions, with the
+	// edges of every tick merged. For per frame choices like pausing, entities get theirs each tick.
+	static ActionSample takeActions();
+
+	// Timeline the update thread takes its dt from, so pausing or scaling it pauses or
+	// scales the whole simulation. Null (the default) runs on the real clock.
+	// The timeline must outlive the engine loop.
+	static void setTimeline(Timeline* timeline);
+	static Timeline* getTimeline();
+
+	// Tilemap level streamed and drawn by the main loop, under the entities. Null for none.
+	// The engine closes it on shutdown, since its chunk textures belong to the renderer.
+	static void setTilemap(Tilemap* tilemap);
+	static Tilemap* getTilemap();
+
+	// Time the last main loop frame took, in nanoseconds
+	static uint64_t getFrameTimeNS();
+
+	// Add an entity to the engine.
+	static void addEntity(Entity* entity);
+
+	// Add an entity and index it under its type, so Engine::each<T>() can find it.
+	// Picked over the Entity* overload whenever the pointer's static type is a subclass.
+	template<class T>
+	static void addEntity(T* entity) {
+		static_assert(std::is_base_of<Entity, T>::value, "Engine entities must derive from Entity");
+		addEntity(static_cast<Entity*>(entity), typeIndex<T>());
+	}
+
+	// Add a body that never moves on its own (platforms, level geometry).
+	// Static bodies are kept out of the update loop and stored in a BVH for queries.
+	static void addStaticEntity(Entity* entity);
+
+	template<class T>
+	static void addStaticEntity(T* entity) {
+		static_assert(std::is_base_of<Entity, T>::value, "Engine entities must derive from Entity");
+		addStaticEntity(static_cast<Entity*>(entity), typeIndex<T>());
+	}
+
+	// Construct an entity of type T in its pool and add it, without touching the global
+	// allocator while the pool has free slots. The handle goes stale once the entity is freed.
+	template<class T, class... Args>
+	static Handle<T> spawn(Args&&... args) {
+		Pool<T>& p = pool<T>();
+		const Handle<T> handle = p.create(std::forward<Args>(args)...);
+		addEntity(p.get(handle));
+		return handle;
+	}
+
+	// Remove an entity from the engine (dynamic or static). It stops being updated, drawn and
+	// returned by queries right away, and is freed once no EpochGuard reader can still hold it.
+	static void removeEntity(Entity* entity);
+
+	// Remove a spawned entity, stale handles are ignored
+	template<class T>
+	static void despawn(Handle<T> handle) {
+		if (T* entity = get(handle)) removeEntity(entity);
+	}
+
+	// The entity behind a spawn handle, null if it has been freed
+	template<class T>
+	static T* get(Handle<T> handle) {
+		return pool<T>().get(handle);
+	}
+
+	// Allocate room for count entities of type T ahead of time (call at load, not per frame).
+	// A texture named here is uploaded now and kept until shutdown, so spawning only looks it up.
+	template<class T>
+	static void reservePool(size_t count, const char* texture = nullptr) {
+		pool<T>().reserve(count);
+		reserveEntities(count, typeIndex<T>());
+		keepTexture(texture);
+	}
+
+	// The pool behind spawn<T>, one per type for the life of the program
+	template<class T>
+	static Pool<T>& pool() {
+		static Pool<T> instance;
+		return instance;
+	}
+
+	// Every entity added as exactly type T, dynamic or static. Costs O(matching entities):
+	//   for (Auto* orb : Engine::each<Auto>()) { ... }
+	template<class T>
+	static EntityView<T> each() {
+		std::vector<Entity*>& scratch = eachScratch();
+		const size_t first = scratch.size();
+		collectType(typeIndex<T>(), scratch);
+		return EntityView<T>(scratch, first);
+	}
+
+	// Compile time type index used for the per-type lists, no RTTI involved
+	template<class T>
+	static size_t typeIndex() {
+		static const size_t index = nextTypeIndex();
+		return index;
+	}
+
+	// Call after moving or resizing a static body so the BVH is rebuilt before the next query.
+	static void markStaticDirty();
+
+	// Appends every static body overlapping area to out.
+	static void queryStatic(const SDL_FRect& area, std::vector<Entity*>& out);
+
+	// Getter for entities, deadlock causing
+	// static const std::vector<Entity*>& getEntities();
+
+	// Safe access: returns a copy/snapshot of the dynamic entity list with no lock held by the caller.
+	// Static bodies are not included, use queryStatic for those.
+	// Use the pointers inside an EpochGuard (the update and render callbacks already are) so a
+	// removed entity isn't freed while the copy still holds it.
+	static std::vector<Entity*> getEntitiesSnapshot();
+
+	// Same, into a list the caller reuses (or a FrameVector), so taking it every frame doesn't allocate
+	template<class Alloc>
+	static void getEntitiesSnapshot(std::vector<Entity*, Alloc>& out) {
+		std::lock_guard<std::mutex> lock(s_entitiesMutex);
+		out.assign(s_entities.begin(), s_entities.end());
+	}
+
+	// The ECS world that runs alongside the Entity list.
+	// Lock getWorldMutex() while touching it from outside a system.
+	static ecs::World& getWorld();
+	static std::mutex& getWorldMutex();
+
+	// Register a system, run in order after the entity updates on every engine step
+	static void addSystem(std::function<void(ecs::World&, float)> system);
+
+	// Getters for the renderer. Null when running headless.
+	static SDL_Renderer* getRenderer();
+
+	// True if the engine was initialized without a window and renderer
+	static bool isHeadless();
+
+	// Camera the main loop draws through. Only entities, static bodies and tilemap chunks
+	// inside its view are drawn, and the tilemap streams around it. Main thread only.
+	static Camera& getCamera();
+
+	// Copy what the renderer needs from every dynamic entity into the render queue.
+	// The update thread calls this after each step, headless callers of step() never need it.
+	static void extractRenderCommands();
+
+    // Initializes the engine
+	static bool init(const Config& cfg);
+
+    // Shuts down the engine and cleans up all resources.
+	static void shutdown();
+
+	// Get the mutex, if needed in game
+	static std::mutex& getEntitiesMutex();
+
+private:
+	// Private members for the engine's core functionality.
+	static SDL_Window* s_window;
+	static SDL_Renderer* s_renderer;
+	static std::atomic<bool> s_running;
+	static bool s_headless;
+	static std::atomic<Timeline*> s_timeline;
+	static std::atomic<Tilemap*> s_tilemap;
+	static Camera s_camera;
+
+	// dt for one entity: its own timeline's delta if it has one, else the step's dt
+	static float entityDelta(Entity* entity, float deltaTime);
+	static std::vector<Entity*> s_entities;
+
+	// Per type index lists, s_typeLists[typeIndex<T>()] holds every entity added as T
+	static std::vector<std::vector<Entity*>> s_typeLists;
+	static void addEntity(Entity* entity, size_t type);
+	static void addStaticEntity(Entity* entity, size_t type);
+	static void indexEntity(Entity* entity, size_t type);
+	static void reserveEntities(size_t count, size_t type);
+	static void keepTexture(const char* path);
+	static void collectType(size_t type, std::vector<Entity*>& out);
+	static std::vector<Entity*>& eachScratch();
+	static size_t nextTypeIndex();
+
+	// ECS world and the systems run on it
+	static ecs::World s_world;
+	static std::mutex s_worldMutex;
+	static std::vector<ecs::EntityId> s_linkScratch; // reused by removeEntity under s_worldMutex
+	static std::vector<std::function<void(ecs::World&, float)>> s_systems;
+	static void runSystems(float deltaTime);
+
+	// Static partition, the BVH is rebuilt lazily when marked dirty
+	static std::vector<Entity*> s_staticEntities;
+	static BVH s_staticTree;
+	static std::shared_mutex s_staticMutex;
+	static std::atomic<bool> s_staticDirty;
+	static void rebuildStaticIfDirty();
+
+	// Pacing for the main loop, and parking for the update thread when it has nothing to do
+	static FramePacer s_framePacer;
+	static int s_updateRate;
+	static std::mutex s_parkMutex;
+	static std::condition_variable s_parkCV;
+
+	// Input is sampled once per update tick, with the tick's time, and kept for takeActions
+	static uint32_t sampleTickInput();
+	static std::atomic<uint32_t> s_actionsHeld;
+	static std::atomic<uint32_t> s_actionsPressed;
+	static std::atomic<uint32_t> s_actionsReleased;
+	static bool hasWork();
+	static void wakeWorker();
+
+	// Draw data handed from the update thread to the main loop, and the entities removed
+	// since, so a frame extracted before a removal doesn't draw it (pointers only compared)
+	static RenderQueue s_renderQueue;
+	static uint64_t s_removalStamp;
+	static std::vector<std::pair<uint64_t, const Entity*>> s_removedLog;
+	static void drawRenderFrame(const RenderFrame& frame, std::vector<const Entity*>& skip);
+
+	// Multithreading private members
+	static std::thread s_updateThread;
+	static std::mutex  s_entitiesMutex;
+	static std::atomic<bool> s_workerRunning;
+};
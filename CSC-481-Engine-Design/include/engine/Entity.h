@@ -1,61 +1,93 @@
-#pragma once
-
-#include <SDL3/SDL.h>
-#include <engine/Types.h>
-
-// The Entity class represents any object in the game world that can be rendered.
-class Entity {
-
-public:
-	// Entity constructor and destructor
-	Entity(float x, float y, float w, float h, const char* texturePath, bool affectedByGravity, bool collidable);
-	virtual ~Entity();
-
-	// Update the entity based on time passed
-	virtual void update(float deltaTime);
-
-	// Draw the texture of the entity
-	virtual void draw();
-
-	// Velocity functions
-	void setVelocity(const Velocity& v);
-	Velocity getVelocity() const;
-
-	// Position functions
-	void setPosition(const OrderedPair& p);
-	OrderedPair getPosition() const;
-
-	// Gravity functions
-	void setAffectedByGravity(bool enabled);
-	bool isAffectedByGravity() const;
-
-	// Collisions functions
-	void setCollidable(bool enabled);
-	bool isCollidable() const;
-
-	// Get the rect of the entity
-	SDL_FRect getRect() const;
-
-	// Getters and setter for client actions and tick
-	void setPendingActions(uint32_t mask);
-	uint32_t getPendingActions() const;
-	void setPendingTick(int t);
-	int getPendingTick() const;
-
-protected:
-	uint32_t pendingActions;
-	int pendingTick;
-
-private:
-    // Core properties of the entity
-	OrderedPair position;
-	OrderedPair dimensions;
-	Velocity velocity;
-
-    // Flags to control physics and collision behavior
-	bool applyGravity;
-	bool collidable;
-
-    // The SDL texture for rendering the entity
-	SDL_Texture* texture;
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <engine/Types.h>
+#include <cstdint>
+
+class PoolBase;
+class Timeline;
+
+// The Entity class represents any object in the game world that can be rendered.
+class Entity {
+
+public:
+	// Entity constructor and destructor
+	Entity(float x, float y, float w, float h, const char* texturePath, bool affectedByGravity, bool collidable);
+	virtual ~Entity();
+
+	// Update the entity based on time passed
+	virtual void update(float deltaTime);
+
+	// Draw the texture of the entity
+	virtual void draw();
+
+	// Velocity functions (direction and magnitude, converted at the call)
+	void setVelocity(const Velocity& v);
+	Velocity getVelocity() const;
+
+	// Velocity as x/y components in px/s, the form physics integrates
+	void setVelocityComponents(const OrderedPair& v);
+	OrderedPair getVelocityComponents() const;
+
+	// Position functions
+	void setPosition(const OrderedPair& p);
+	OrderedPair getPosition() const;
+
+	// Gravity functions
+	void setAffectedByGravity(bool enabled);
+	bool isAffectedByGravity() const;
+
+	// Collisions functions
+	void setCollidable(bool enabled);
+	bool isCollidable() const;
+
+	// Timeline this entity's worker updates follow, usually a child of the engine timeline.
+	// Null (the default) uses the engine's dt. The timeline must outlive the entity.
+	void setTimeline(Timeline* t);
+	Timeline* getTimeline() const;
+
+	// Get the rect of the entity
+	SDL_FRect getRect() const;
+
+	// Draw order among dynamic entities, higher layers draw on top (default 0)
+	void setLayer(int l);
+	int getLayer() const;
+
+	// Getters and setter for client actions and tick
+	void setPendingActions(uint32_t mask);
+	uint32_t getPendingActions() const;
+	void setPendingTick(int t);
+	int getPendingTick() const;
+
+	// Driven by the local keyboard: every update tick sets the actions it sampled as pending
+	void setInputControlled(bool enabled);
+	bool isInputControlled() const;
+
+protected:
+	uint32_t pendingActions;
+	int pendingTick;
+
+private:
+    // Core properties of the entity
+	OrderedPair position;
+	OrderedPair dimensions;
+	OrderedPair velocity; // components, so integration needs no sqrt or renormalizing
+
+    // Flags to control physics and collision behavior
+	bool applyGravity;
+	bool collidable;
+
+    // The SDL texture for rendering the entity
+	SDL_Texture* texture;
+	int layer = 0;
+	bool inputControlled = false;
+
+	// The pool this entity lives in, null if it was made with new
+	PoolBase* ownerPool = nullptr;
+	friend class PoolBase;
+
+	// Own timeline and its time at the last update, read by the engine
+	Timeline* timeline = nullptr;
+	int64_t lastTimeNS = 0;
+	friend class Engine;
 };
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class Entity;
+
+// Epoch based reclamation for entities.
+// Threads that read raw Entity pointers (the worker, the render loop, gameplay code holding a
+// snapshot) do it inside an EpochGuard. A removed entity is retired with the epoch it was removed
+// in and only freed once every thread inside a guard has entered a later epoch, so no reader
+// can still be holding it.
+class Epoch {
+public:
+	// Most threads that can be inside a guard at the same time
+	static constexpr int kMaxThreads = 64;
+
+	// Marks the calling thread as a reader until exit() (guards may nest)
+	static void enter();
+	static void exit();
+
+	// Queue an entity to be freed once no reader can see it.
+	// It must already be unreachable from the engine's lists.
+	static void retire(Entity* entity);
+
+	// Make room for count more retired entities, so retiring and collecting them doesn't allocate
+	static void reserve(size_t count);
+
+	// Advance the epoch and free what no reader can still hold. Call outside any guard.
+	// @return The number of entities freed.
+	static size_t collect();
+
+	// Entities waiting to be freed
+	static size_t pending();
+
+	// Free everything now, for shutdown once every reader has stopped
+	static void drain();
+
+private:
+	struct Retired {
+		Entity* entity;
+		uint64_t epoch;
+	};
+
+	// Per thread slot, holds the epoch seen on entry or 0 when outside a guard
+	struct alignas(64) Slot {
+		std::atomic<uint64_t> epoch{ 0 };
+		std::atomic<bool> used{ false };
+	};
+
+	static int threadSlot();
+
+	static std::atomic<uint64_t> s_epoch;
+	static Slot s_slots[kMaxThreads];
+	static std::vector<Retired> s_retired;
+	static std::mutex s_retiredMutex;
+	static std::vector<Entity*> s_ready; // collect's list of entities to free, reused
+	static std::mutex s_collectMutex;    // one collect at a time, they share s_ready
+};
+
+// Keeps the calling thread inside a read epoch for its scope
+class EpochGuard {
+public:
+	EpochGuard() { Epoch::enter(); }
+	~EpochGuard() { Epoch::exit(); }
+	EpochGuard(const EpochGuard&) = delete;
+	EpochGuard& operator=(const EpochGuard&) = delete;
+};
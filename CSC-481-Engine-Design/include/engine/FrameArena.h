@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// The FrameArena class hands out per-frame scratch memory by bumping an offset through one block.
+// Nothing is freed on its own: reset() at the start of the next frame or step frees it all at once.
+// A frame that needs more than the block spills into extra blocks, and the next reset grows the
+// block to that frame's peak, so after warm up a frame never touches the global allocator.
+// Each thread has its own arena (local()), reset by the loop that owns the thread.
+class FrameArena {
+public:
+	explicit FrameArena(size_t capacity = 64 * 1024);
+	~FrameArena();
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+
+	// Memory for size bytes at the given alignment, valid until the next reset
+	void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	// Free everything handed out since the last reset
+	void reset();
+
+	// Bytes handed out since the last reset, and the size of the main block
+	size_t used() const;
+	size_t capacity() const;
+
+	// The calling thread's arena
+	static FrameArena& local();
+
+private:
+	char* block = nullptr;
+	size_t blockSize = 0;
+	size_t offset = 0;
+	size_t spilled = 0;           // bytes that didn't fit in the block this frame
+	std::vector<char*> overflow;  // extra blocks, freed at reset
+};
+
+// Standard allocator over a FrameArena, so containers can live in frame scratch.
+// Deallocation does nothing, the memory comes back when the arena resets. A container
+// using it must not outlive the frame.
+template<class T>
+class FrameAllocator {
+public:
+	using value_type = T;
+
+	FrameAllocator() : arena(&FrameArena::local()) {}
+	explicit FrameAllocator(FrameArena& arena) : arena(&arena) {}
+	template<class U>
+	FrameAllocator(const FrameAllocator<U>& other) : arena(other.arena) {}
+
+	T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+	void deallocate(T*, size_t) {}
+
+	template<class U>
+	bool operator==(const FrameAllocator<U>& other) const { return arena == other.arena; }
+	template<class U>
+	bool operator!=(const FrameAllocator<U>& other) const { return arena != other.arena; }
+
+private:
+	template<class U> friend class FrameAllocator;
+	FrameArena* arena;
+};
+
+// A vector in the calling thread's frame scratch
+template<class T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
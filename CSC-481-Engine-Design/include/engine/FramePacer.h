@@ -0,0 +1,49 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+
+// The FramePacer class holds a loop to a target rate with deadline waits.
+// Each wait sleeps until shortly before the deadline, then spins the rest, so frames land on
+// time without burning a core. The spin margin adapts to how late the OS wakes the thread.
+// With vsync on, presenting already blocks to the display, so the pacer only waits when
+// the target is below the refresh rate.
+class FramePacer {
+public:
+	// targetHz <= 0 leaves the loop unpaced
+	explicit FramePacer(double targetHz = 0.0);
+
+	void setTargetRate(double hz);
+	double getTargetRate() const;
+
+	// Tell the pacer that something else blocks each frame at refreshHz (0 for no vsync)
+	void setVsync(double refreshHz);
+
+	// Block until the next frame deadline. Falling more than a frame behind restarts the
+	// schedule from now instead of running frames back to back to catch up.
+	void wait();
+
+	// Start the schedule over from now (after a pause or a long stall)
+	void reset();
+
+	// Duration of the last frame, wait included, in nanoseconds
+	uint64_t getFrameTimeNS() const;
+
+	// Current spin margin, the wake up error the pacer allows for
+	uint64_t getSpinMarginNS() const;
+
+	// Sleep then spin until an SDL_GetTicksNS deadline. spinMarginNS is how long before the
+	// deadline to stop sleeping. Returns how late the sleep woke past its target, 0 if it didn't sleep.
+	static uint64_t sleepUntilNS(uint64_t deadlineNS, uint64_t spinMarginNS);
+
+private:
+	uint64_t periodNS = 0;
+	uint64_t vsyncPeriodNS = 0;
+	uint64_t nextDeadlineNS = 0;
+	uint64_t lastFrameStartNS = 0;
+	uint64_t frameTimeNS = 0;
+	uint64_t spinMarginNS = 1000000; // start at 1 ms until the real error is known
+
+	static constexpr uint64_t kMinSpinNS = 100000;   // 0.1 ms
+	static constexpr uint64_t kMaxSpinNS = 4000000;  // 4 ms, timer resolution on a busy Windows box
+};
@@ -1,30 +1,75 @@
-#pragma once
-
-#include <SDL3/SDL.h>
-#include <cstdint>
-#include <unordered_map>
-
-class Input {
-public:
-    // Asks if a key is currently being pressed.
-    static bool isKeyPressed(SDL_Scancode key);
-
-    // Grabs the latest keyboard state. Call this once per frame.
-    static void updateKeyboardState();
-
-	// Bind a key to an action bit index (0 to 31)
-	static void bindAction(SDL_Scancode key, uint32_t bit);
-
-	// Clear all bindings
-	static void clearBindings();
-
-	// Build an action mask for this fram
-	static uint32_t getActionMask();
-
-private:
-    // A list of all keys on the keyboard and whether each one is pressed or not.
-    static const bool* keyboardState;
-
-	// Map from SDL key to which bit it controls
-	static std::unordered_map<SDL_Scancode, uint32_t> keyBindings;
-};
\ No newline at end of file
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <mutex>
+
+// Actions seen over one sampling window (one simulation tick or one frame)
+struct ActionSample {
+	uint32_t held = 0;     // actions down at the end of the window
+	uint32_t pressed = 0;  // actions that went down during the window
+	uint32_t released = 0; // actions that went up during the window
+
+	// Held at the end or pressed at any point, so a tap shorter than the window still counts
+	uint32_t active() const { return held | pressed; }
+};
+
+class Input {
+public:
+    // Asks if a key is currently being pressed.
+    static bool isKeyPressed(SDL_Scancode key);
+
+    // Grabs the latest keyboard state. Call this once per frame.
+    static void updateKeyboardState();
+
+	// Feed an SDL event. Key transitions are queued with SDL's nanosecond timestamp,
+	// so presses and releases keep their order and timing no matter the frame rate.
+	static void processEvent(const SDL_Event& event);
+
+	// Bind a key to an action bit index (0 to 31)
+	static void bindAction(SDL_Scancode key, uint32_t bit);
+
+	// Clear all bindings
+	static void clearBindings();
+
+	// Consume every queued transition up to untilNS (SDL_GetTicksNS time) and report the window.
+	// A fixed step simulation calls this once per tick with the tick's end time.
+	static ActionSample sampleActions(uint64_t untilNS);
+
+	// Build an action mask for this frame: everything active since the last call.
+	// It consumes the queue too, so only for loops the engine's update ticks don't sample for.
+	static uint32_t getActionMask();
+
+private:
+	// One queued key transition, mask is the key's bound actions at the time
+	struct KeyEvent {
+		uint64_t timeNS;
+		uint32_t mask;
+		bool down;
+	};
+
+	static void push(const KeyEvent& event);
+	static void applyEvent(const KeyEvent& event);
+
+    // A list of all keys on the keyboard and whether each one is pressed or not.
+    static const bool* keyboardState;
+
+	// Flat table from scancode to the action bits it controls
+	static uint32_t keyBindings[SDL_SCANCODE_COUNT];
+
+	// Keys down according to the event stream, used to drop repeats and stray releases
+	static bool keyDown[SDL_SCANCODE_COUNT];
+
+	// Ring buffer of transitions not yet consumed
+	static constexpr uint32_t kQueueSize = 256;
+	static KeyEvent queue[kQueueSize];
+	static uint32_t queueHead;
+	static uint32_t queueCount;
+
+	// Consumed state: keys down per action bit, and edges not yet reported
+	static uint8_t heldCount[32];
+	static uint32_t pendingPressed;
+	static uint32_t pendingReleased;
+
+	static std::mutex inputMutex;
+};
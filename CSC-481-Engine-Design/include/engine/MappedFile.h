@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// The MappedFile class maps a whole file read-only into memory.
+// The contents can be read straight from the mapping without copying or parsing.
+class MappedFile {
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	// A mapping owns OS handles, so it can be moved but not copied
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+
+	// Map the file at path, returns false if it can't be opened or mapped
+	bool open(const std::string& path);
+
+	// Unmap the file and release the handles
+	void close();
+
+	bool isOpen() const;
+
+	// Start of the mapped bytes and their count
+	const char* data() const;
+	size_t size() const;
+
+private:
+	void swap(MappedFile& other) noexcept;
+
+	const char* bytes = nullptr;
+	size_t length = 0;
+
+	// Platform handles (file descriptor or HANDLEs on Windows)
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+	int fd = -1;
+};
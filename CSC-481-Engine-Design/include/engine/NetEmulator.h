@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+// How one direction of an emulated link misbehaves. All zero is a perfect link.
+struct LinkConditions {
+	float delayMs = 0.0f;    // one way latency
+	float jitterMs = 0.0f;   // each message is delayed a further 0..jitterMs, order is kept
+	float loss = 0.0f;       // chance each message is dropped, 0..1
+	float reorder = 0.0f;    // chance a message is held back reorderMs so later ones overtake it, 0..1
+	float reorderMs = 50.0f;
+	float rateKbps = 0.0f;   // bandwidth cap in kilobits per second, 0 for none
+	float queueMs = 500.0f;  // messages that would wait longer than this for the cap are dropped
+};
+
+// Counts for one direction since the last take
+struct LinkStats {
+	uint64_t submitted = 0;
+	uint64_t delivered = 0;
+	uint64_t lost = 0;       // dropped by the loss chance
+	uint64_t overflowed = 0; // dropped because the bandwidth queue was full
+	uint64_t reordered = 0;
+	uint64_t bytes = 0;      // delivered bytes
+};
+
+// A message held by the emulator: its frames, and which socket the owner sends it out on
+struct EmulatedMessage {
+	int channel = 0;
+	std::vector<std::string> frames;
+	size_t bytes() const;
+};
+
+// The LinkEmulator class delays, drops, reorders and rate limits the messages of one direction
+// of a link. The owner submits messages as they arrive and sends each one when take() hands it
+// back. Times are steady clock nanoseconds passed in by the caller. Single thread.
+class LinkEmulator {
+public:
+	explicit LinkEmulator(uint32_t seed = 1);
+
+	void setConditions(const LinkConditions& c);
+	const LinkConditions& getConditions() const;
+
+	/**
+	 * Queues a message, or drops it.
+	 * @param message The message, moved from.
+	 * @param nowNS The time it arrived.
+	 * @return false if it was dropped.
+	 */
+	bool submit(EmulatedMessage&& message, uint64_t nowNS);
+
+	// Moves out the next message that is due by nowNS, returns false if none is
+	bool take(uint64_t nowNS, EmulatedMessage& out);
+
+	// Milliseconds until the next message is due (0 if one is due now), -1 if nothing is queued
+	int msUntilNext(uint64_t nowNS) const;
+
+	size_t queued() const;
+
+	// Counts since the last call, then start over
+	LinkStats takeStats();
+
+private:
+	struct Pending {
+		uint64_t dueNS;
+		uint64_t order; // arrival order, breaks ties so equal due times stay in order
+		EmulatedMessage message;
+	};
+	static bool later(const Pending& a, const Pending& b);
+
+	LinkConditions conditions;
+	LinkStats stats;
+	std::vector<Pending> heap; // min heap on dueNS
+	std::mt19937 rng;
+	uint64_t nextOrder = 0;
+	uint64_t lastDueNS = 0;   // keeps jittered messages in order
+	uint64_t linkFreeNS = 0;  // when the bandwidth cap has sent everything queued so far
+};
@@ -1,35 +1,58 @@
-#pragma once
-#include "Types.h"  // for OrderedPair
-#include <vector>
-
-// Client info sent to server
-struct ClientCommand {
-	int clientId;
-	uint32_t actions; // 32 bit action mask, lets each game set an action to a bit
-	int tick;
-	float x;
-	float y;
-};
-
-// Stored on the server
-struct PlayerState {
-	int tick = 0;
-	uint32_t actions = 0;
-	float x = 0.0f;
-	float y = 0.0f;
-};
-
-// Synced object data
-struct SyncedObjectData {
-    int id;
-    int type;
-    OrderedPair position;
-};
-
-// World snapshot sent from server to client
-struct WorldSnapshot {
-	int tick;
-	std::vector<int> playerIds;
-	std::vector<OrderedPair> playerPositions;
-	std::vector<SyncedObjectData> syncedObjects; // Changed from autoPositions
-};
+#pragma once
+#include "Types.h"  // for OrderedPair
+#include <cstdint>
+#include <vector>
+
+// Client info sent to server
+struct ClientCommand {
+	int clientId;
+	uint32_t actions; // 32 bit action mask, lets each game set an action to a bit
+	int tick;
+	float x;
+	float y;
+	int room = 0; // match the command is for, the client fills it in from connect()
+	int seenTick = -1; // tick of the newest snapshot the client had applied, -1 before the first
+};
+
+// Hazard rules the server enforces for the game. Both read them from here so they can't drift apart.
+constexpr uint32_t HAZARD_DODGE_ACTION = 1u << 1; // action bit that starts a dodge, hazards miss a dodging player
+constexpr float HAZARD_DODGE_SECONDS = 3.0f;     // how long a dodge lasts
+
+// Synced object data
+struct SyncedObjectData {
+    int id;
+    int type;
+    OrderedPair position;
+};
+
+// World snapshot sent from server to client
+struct WorldSnapshot {
+	int tick;
+	std::vector<int> playerIds;
+	std::vector<OrderedPair> playerPositions;
+	std::vector<SyncedObjectData> syncedObjects; // Changed from autoPositions
+	std::vector<int> playerHits; // hazard hits the server has counted for each player, same order as playerIds
+
+	// A partial snapshot only has the players and objects that fit the client's bandwidth budget.
+	// The roster lists every player in the room, so a missing one isn't taken as gone.
+	bool partial = false;
+	std::vector<int> roster;
+};
+
+// Server health over one reporting window, published on the telemetry endpoint
+struct ServerStats {
+	int tick = 0;
+	int rooms = 0;
+	int clients = 0;
+	float tickP50Ms = 0.0f;     // tick work time percentiles
+	float tickP95Ms = 0.0f;
+	float tickP99Ms = 0.0f;
+	float tickMaxMs = 0.0f;
+	uint32_t overruns = 0;      // ticks that took longer than the tick period
+	float commandsPerSec = 0.0f;
+	float snapshotBytesPerSec = 0.0f;
+	float roomsLockAvgUs = 0.0f; // waits to lock roomsMutex
+	float roomsLockMaxUs = 0.0f;
+	float objectsLockAvgUs = 0.0f; // waits to lock objectsMutex
+	float objectsLockMaxUs = 0.0f;
+};
@@ -1,18 +1,54 @@
-#pragma once
-
-#include "Entity.h"
-
-// The Physics class manages physics-related operations like gravity.
-// It is a static class because it doesn't need to store per-object state.
-class Physics {
-public:
-    // Sets the global gravity strength.
-    static void setGravity(float gravity);
-    // Gets the current gravity strength.
-    static float getGravity();
-    // Applies gravity and velocity to an entity.
-    static void apply(Entity* entity, float deltaTime);
-private:
-    // The global gravity value.
-    static float gravityWeight;
-};
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "Entity.h"
+
+// Bodies stored back to back so they can be integrated in bulk.
+// positions[i] and velocities[i] belong to the same body; velocities are components in px/s.
+struct BodyBatch {
+    std::vector<OrderedPair> positions;
+    std::vector<OrderedPair> velocities;
+
+    void resize(size_t count) { positions.resize(count); velocities.resize(count); }
+    size_t size() const { return positions.size(); }
+};
+
+// The Physics class manages physics-related operations like gravity.
+// It is a static class because it doesn't need to store per-object state.
+class Physics {
+public:
+    // How positions and velocities are advanced each step
+    enum class Integrator {
+        SemiImplicitEuler, // v += a*dt, then x += v*dt
+        Verlet             // velocity Verlet: x += (v + a*dt/2)*dt, then v += a*dt
+    };
+
+    // Sets the global gravity strength.
+    static void setGravity(float gravity);
+    // Gets the current gravity strength.
+    static float getGravity();
+    // Gravity as an acceleration vector (positive Y is down).
+    static OrderedPair getGravityAcceleration();
+
+    // Selects the integrator used by every integrate call.
+    static void setIntegrator(Integrator integrator);
+    static Integrator getIntegrator();
+
+    // Applies gravity to an entity's velocity.
+    static void apply(Entity* entity, float deltaTime);
+
+    // Advances one body by deltaTime under a constant acceleration.
+    static void integrate(OrderedPair& position, OrderedPair& velocity, OrderedPair acceleration, float deltaTime);
+
+    // Advances count bodies stored in contiguous arrays, all under the same acceleration.
+    // Uses SIMD kernels where available, several bodies per instruction.
+    static void integrate(OrderedPair* positions, OrderedPair* velocities, size_t count,
+                          OrderedPair acceleration, float deltaTime);
+    static void integrate(BodyBatch& batch, OrderedPair acceleration, float deltaTime);
+private:
+    // The global gravity value.
+    static float gravityWeight;
+    // The selected integrator.
+    static Integrator integrator;
+};
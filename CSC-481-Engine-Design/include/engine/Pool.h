@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class Entity;
+
+// Handle to a pooled object. The generation changes every time a slot is reused,
+// so a handle kept after its object was destroyed resolves to null instead of to a stranger.
+template<class T>
+struct Handle {
+	uint32_t index = UINT32_MAX;
+	uint32_t generation = 0;
+
+	bool isNull() const { return index == UINT32_MAX; }
+	bool operator==(const Handle& o) const { return index == o.index && generation == o.generation; }
+	bool operator!=(const Handle& o) const { return !(*this == o); }
+};
+
+// Type erased part of every entity pool, so the engine can free an entity without knowing its type.
+class PoolBase {
+public:
+	virtual ~PoolBase() = default;
+
+	// Frees an entity: back to its pool if it came from one, otherwise with delete
+	static void free(Entity* entity);
+
+	// Live objects and slots allocated so far
+	virtual size_t live() const = 0;
+	virtual size_t capacity() const = 0;
+
+protected:
+	virtual void releaseEntity(Entity* entity) = 0;
+	static void setOwner(Entity* entity, PoolBase* pool);
+};
+
+// The Pool class stores objects of one entity type in fixed size blocks of slots.
+// Blocks never move, so pointers stay valid, and freed slots go on a freelist for the next create.
+// Only growing past the reserved capacity touches the global allocator.
+template<class T>
+class Pool : public PoolBase {
+	static_assert(std::is_base_of<Entity, T>::value, "Pool only stores Entity types");
+
+public:
+	// Slots per block, objects in one block are contiguous
+	static constexpr uint32_t kBlockSize = 64;
+
+	Pool() = default;
+	~Pool() override {
+		for (uint32_t i = 0; i < slotCount; ++i) {
+			Slot& s = slot(i);
+			if (s.alive) object(s)->~T();
+		}
+	}
+
+	Pool(const Pool&) = delete;
+	Pool& operator=(const Pool&) = delete;
+
+	// Allocate slots up front so the next count creates don't allocate
+	void reserve(size_t count) {
+		std::lock_guard<std::mutex> lock(mutex);
+		while (slotCount < count) grow();
+	}
+
+	// Construct an object in a free slot
+	template<class... Args>
+	Handle<T> create(Args&&... args) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (freeHead == UINT32_MAX) grow();
+
+		const uint32_t index = freeHead;
+		Slot& s = slot(index);
+		freeHead = s.nextFree;
+		T* obj = new (s.storage) T(std::forward<Args>(args)...);
+		s.alive = true;
+		setOwner(obj, this);
+		++liveCount;
+		return Handle<T>{ index, s.generation };
+	}
+
+	// Destroy the object behind a handle, stale handles are ignored
+	void destroy(Handle<T> handle) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!valid(handle)) return;
+		destroySlot(handle.index);
+	}
+
+	// The object behind a handle, null if the handle is stale
+	T* get(Handle<T> handle) const {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!valid(handle)) return nullptr;
+		return object(slot(handle.index));
+	}
+
+	size_t live() const override {
+		std::lock_guard<std::mutex> lock(mutex);
+		return liveCount;
+	}
+
+	size_t capacity() const override {
+		std::lock_guard<std::mutex> lock(mutex);
+		return slotCount;
+	}
+
+protected:
+	void releaseEntity(Entity* entity) override {
+		std::lock_guard<std::mutex> lock(mutex);
+		// storage is the first member, so the object address is the slot address
+		const Slot* s = reinterpret_cast<const Slot*>(static_cast<T*>(entity));
+		for (uint32_t b = 0; b < blocks.size(); ++b) {
+			const Slot* first = blocks[b].get();
+			if (s >= first && s < first + kBlockSize) {
+				destroySlot(b * kBlockSize + static_cast<uint32_t>(s - first));
+				return;
+			}
+		}
+	}
+
+private:
+	struct Slot {
+		alignas(T) unsigned char storage[sizeof(T)];
+		uint32_t generation = 0;
+		uint32_t nextFree = UINT32_MAX;
+		bool alive = false;
+	};
+
+	Slot& slot(uint32_t index) { return blocks[index / kBlockSize][index % kBlockSize]; }
+	const Slot& slot(uint32_t index) const { return blocks[index / kBlockSize][index % kBlockSize]; }
+	static T* object(const Slot& s) { return std::launder(reinterpret_cast<T*>(const_cast<unsigned char*>(s.storage))); }
+
+	bool valid(Handle<T> handle) const {
+		if (handle.index >= slotCount) return false;
+		const Slot& s = slot(handle.index);
+		return s.alive && s.generation == handle.generation;
+	}
+
+	// Adds a block and threads its slots onto the freelist in order
+	void grow() {
+		blocks.emplace_back(new Slot[kBlockSize]);
+		const uint32_t base = slotCount;
+		slotCount += kBlockSize;
+		for (uint32_t i = kBlockSize; i-- > 0;) {
+			blocks.back()[i].nextFree = freeHead;
+			freeHead = base + i;
+		}
+	}
+
+	void destroySlot(uint32_t index) {
+		Slot& s = slot(index);
+		object(s)->~T();
+		s.alive = false;
+		++s.generation;
+		s.nextFree = freeHead;
+		freeHead = index;
+		--liveCount;
+	}
+
+	std::vector<std::unique_ptr<Slot[]>> blocks;
+	uint32_t slotCount = 0;
+	uint32_t freeHead = UINT32_MAX;
+	size_t liveCount = 0;
+	mutable std::mutex mutex;
+};
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+// Where one tracked thing was on one tick
+struct HistoryBox {
+	int id;
+	SDL_FRect rect;
+};
+
+// The PositionHistory class keeps the boxes of everything tracked for the last few ticks, so a
+// server can check a command against the world the client was looking at when it sent it.
+// It's a ring: starting a tick reuses the slot of the oldest one. Room is reserved up front, so
+// recording never allocates. Single thread.
+class PositionHistory {
+public:
+	// Keeps `ticks` ticks of up to `perTick` boxes each
+	PositionHistory(int ticks, int perTick);
+
+	// Start recording a tick, the oldest tick is forgotten. Ticks must increase.
+	void beginTick(int tick);
+
+	// Add a box to the tick being recorded, ignored once the tick is full
+	void record(int id, const SDL_FRect& rect);
+
+	/**
+	 * Looks up where something was.
+	 * @param tick The tick, clamp it first to rewind as far as the history goes.
+	 * @param id The tracked id.
+	 * @param out Receives its box.
+	 * @return false if the tick is outside the history or the id wasn't recorded on it.
+	 */
+	bool find(int tick, int id, SDL_FRect& out) const;
+
+	// The nearest tick the history still has, -1 while it's empty
+	int clamp(int tick) const;
+
+	int newest() const;
+	int oldest() const;
+
+private:
+	struct Frame {
+		int tick = -1;
+		std::vector<HistoryBox> boxes;
+	};
+
+	const Frame* frameOf(int tick) const;
+
+	std::vector<Frame> frames;
+	size_t perTick;
+	int newestTick = -1;
+	int recorded = 0; // ticks recorded so far, up to frames.size()
+};
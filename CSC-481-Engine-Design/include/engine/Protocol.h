@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "NetworkTypes.h"
+
+// The Protocol class encodes and decodes the text messages sent between client and server.
+// It is a static class so the client, the server and the replay tools share one wire format.
+//   Command:  CMD <clientId> <tick> <actions> <x> <y> [room [seenTick]]
+//   Snapshot: SNAP <tick> <numPlayers> <numObjects> [id x y]... [objId objType objX objY]... [hits]...
+//             published as a second frame after the room's topic frame
+//   Partial:  PSNAP <tick> <numPlayers> <numObjects> <numRoster> [id x y hits]... [objId objType objX objY]...
+//             [rosterId]...   sent to one player after its player topic frame
+//   Stats:    STATS <tick> <rooms> <clients> <p50> <p95> <p99> <max> <overruns> <cmd/s> <snapBytes/s>
+//                   <roomsAvgUs> <roomsMaxUs> <objectsAvgUs> <objectsMaxUs>
+class Protocol {
+public:
+	// Build the wire message for a client command
+	static std::string encodeCommand(const ClientCommand& cmd);
+
+	// Same, into a buffer the caller reuses so sending doesn't allocate
+	static void encodeCommand(const ClientCommand& cmd, std::string& out);
+
+	// Parse a command message, returns false if it is malformed
+	static bool decodeCommand(const char* data, size_t size, ClientCommand& outCmd);
+
+	// Build the wire message for a world snapshot
+	static std::string encodeSnapshot(const WorldSnapshot& snapshot);
+	static void encodeSnapshot(const WorldSnapshot& snapshot, std::string& out);
+
+	// Parse a snapshot message, returns false if it is malformed
+	static bool decodeSnapshot(const char* data, size_t size, WorldSnapshot& outSnapshot);
+
+	// Topic frame in front of a room's snapshots, subscribe to it to get only that room
+	static std::string roomTopic(int room);
+
+	// Topic frame in front of the partial snapshots for one player in a room
+	static std::string playerTopic(int room, int clientId);
+
+	// Server telemetry, published separately from the game traffic
+	static void encodeStats(const ServerStats& stats, std::string& out);
+	static bool decodeStats(const char* data, size_t size, ServerStats& outStats);
+
+private:
+	static void encodePartial(const WorldSnapshot& snapshot, std::string& out);
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include "MappedFile.h"
+
+// Kinds of records stored in a session log
+enum class RecordType : uint32_t {
+	Snapshot = 1, // a SNAP message as it went over the wire
+	Command = 2   // a CMD message as it went over the wire
+};
+
+// One record read back from a session log. The payload points into the mapped file.
+struct ReplayRecord {
+	RecordType type;
+	int tick;
+	uint64_t timeNS; // time since the recording started
+	const char* data;
+	size_t size;
+};
+
+// The Recorder class appends tick stamped network messages to a binary session log.
+// Layout: file header, then [RecordHeader][payload padded to 8 bytes] repeated.
+// It is safe to call from several threads (the server's network thread records commands and
+// the room pool threads record snapshots).
+class Recorder {
+public:
+	Recorder() = default;
+	~Recorder();
+
+	Recorder(const Recorder&) = delete;
+	Recorder& operator=(const Recorder&) = delete;
+
+	// Create a log, truncating any existing file at the path
+	bool open(const std::string& path);
+	void close();
+	bool isOpen() const;
+
+	// Append one message to the log
+	void record(RecordType type, int tick, const void* data, size_t size);
+	void record(RecordType type, int tick, const std::string& message);
+
+	// Push buffered records to disk so a crash keeps everything up to here
+	void flush();
+
+private:
+	std::FILE* file = nullptr;
+	uint64_t startNS = 0;
+	mutable std::mutex fileMutex;
+};
+
+// The Replay class memory maps a session log and walks its records in order.
+class Replay {
+public:
+	// Map a log, returns false if it is missing or not a session log
+	bool open(const std::string& path);
+	void close();
+	bool isOpen() const;
+
+	// Read the next record, returns false at the end of the log.
+	// A record cut short by a crash is treated as the end.
+	bool next(ReplayRecord& outRecord);
+
+	// Read the next record of one type, skipping the others
+	bool next(RecordType type, ReplayRecord& outRecord);
+
+	// Start again from the first record
+	void rewind();
+
+private:
+	MappedFile file;
+	size_t cursor = 0;
+};
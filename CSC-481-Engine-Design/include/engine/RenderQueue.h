@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+class Entity;
+
+// What the renderer needs to draw one entity, copied out at the end of a simulation step
+struct RenderCommand {
+	const Entity* source;   // only compared by the renderer, never dereferenced
+	SDL_Texture* texture;
+	SDL_FRect rect;         // world space
+	int layer;
+};
+
+// Every command extracted in one simulation step
+struct RenderFrame {
+	std::vector<RenderCommand> commands;
+	uint64_t removalStamp = 0; // engine removal count when it was extracted
+};
+
+// The RenderQueue class hands finished command lists from the simulation to the renderer.
+// The simulation fills its back frame and publishes it; the renderer takes the newest
+// published frame. A third frame sits between the two, so neither side ever waits for
+// the other and a frame is never written while it is being drawn.
+class RenderQueue {
+public:
+	RenderQueue() = default;
+
+	RenderQueue(const RenderQueue&) = delete;
+	RenderQueue& operator=(const RenderQueue&) = delete;
+
+	// Producer: the frame to fill, emptied and ready for commands
+	RenderFrame& beginFrame();
+
+	// Producer: hand the filled frame to the renderer
+	void publish();
+
+	// Consumer: the newest published frame, valid until the next acquire. Null before the first publish.
+	const RenderFrame* acquire();
+
+	// Drop every frame (both sides must be stopped)
+	void clear();
+
+private:
+	RenderFrame frames[3];
+	int backIndex = 0;  // producer only
+	int readyIndex = 1; // last published, swapped under mutex
+	int frontIndex = 2; // consumer only
+	bool fresh = false; // ready holds a frame the consumer hasn't taken
+	bool started = false; // front holds a published frame
+	std::mutex mutex;
+};
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <engine/MappedFile.h>
+
+// Scene file layout, every record is used in place from the mapping (little endian):
+//   SceneHeader
+//   uint32_t textures[textureCount]     string table offset of each texture path
+//   SceneEntity entities[entityCount]
+//   SceneObject objects[objectCount]
+//   char strings[stringsSize]           null terminated strings
+// Sections start on 8 byte boundaries. scene_convert writes these from a text scene.
+struct SceneHeader {
+	char magic[8];          // "CSCSCEN"
+	uint32_t version;
+	uint32_t textureCount;
+	uint32_t entityCount;
+	uint32_t objectCount;
+	uint32_t stringsSize;
+	uint32_t tilemap;       // string offset of the level's .tmap path, kNone for none
+	uint64_t texturesOffset;
+	uint64_t entitiesOffset;
+	uint64_t objectsOffset;
+	uint64_t stringsOffset;
+};
+
+// One entity to create on load. What it becomes is up to the factory registered for its kind.
+struct SceneEntity {
+	enum Flags : uint32_t {
+		Static = 1u << 0,     // level geometry, add with Engine::addStaticEntity
+		Collidable = 1u << 1,
+		Gravity = 1u << 2,
+	};
+
+	uint32_t kind;          // string offset of the kind name, e.g. "Player"
+	uint32_t texture;       // texture table index, kNone for none
+	uint32_t flags;
+	float x, y, w, h;
+};
+
+// One object the server simulates and sends in snapshots
+struct SceneObject {
+	int32_t id;
+	int32_t type;           // 0 = platform, 1 = orb, same as SyncedObject
+	float x, y, w, h;       // spawn position and size
+	float vx, vy;           // starting velocity
+	float minX, maxX;       // patrol range for platforms
+};
+
+// The Scene class maps a scene file and turns its records into entities.
+// Nothing is parsed on load: the header is checked once and the records are read in place,
+// so loading a level costs one mapping plus the entities it creates.
+class Scene {
+public:
+	static constexpr uint32_t kVersion = 1;
+	static constexpr uint32_t kNone = UINT32_MAX;
+
+	// Creates whatever a record of one kind stands for. texture is null if the record has none.
+	using Factory = std::function<void(const SceneEntity& record, const char* texture)>;
+
+	Scene() = default;
+
+	// Map a scene file, returns false if it can't be mapped or isn't a valid scene
+	bool open(const std::string& path);
+	void close();
+	bool isOpen() const;
+
+	// Register the factory for a kind name, before instantiate()
+	void registerKind(const std::string& kind, Factory factory);
+
+	// Run the registered factory of every entity record, in file order.
+	// Records of unregistered kinds are skipped. Returns how many were created.
+	size_t instantiate() const;
+
+	// Records, straight from the mapping
+	const SceneEntity* entities() const;
+	uint32_t entityCount() const;
+	const SceneObject* objects() const;
+	uint32_t objectCount() const;
+
+	// Texture path by table index, null for kNone or out of range
+	const char* texture(uint32_t index) const;
+
+	// Kind name of a record
+	const char* kindOf(const SceneEntity& record) const;
+
+	// The level's tilemap file, null if the scene has none
+	const char* tilemap() const;
+
+private:
+	// String at a table offset, null if it's out of range
+	const char* string(uint32_t offset) const;
+
+	MappedFile file;
+	const SceneHeader* header = nullptr;
+	const uint32_t* textureTable = nullptr;
+	const SceneEntity* entityRecords = nullptr;
+	const SceneObject* objectRecords = nullptr;
+	const char* strings = nullptr;
+
+	std::unordered_map<std::string, Factory> kinds;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// A value one thread writes and any number of threads read, without locks on either side.
+// The writer bumps a sequence number to odd, copies the value in and bumps it back to even;
+// a reader copies the value out and retries if the sequence was odd or changed meanwhile.
+// Writes never wait, reads only repeat while a write is in progress. The value is stored
+// as relaxed atomic words, so a torn copy is never undefined behavior, only retried.
+template<class T>
+class SeqLock {
+	static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied as raw words");
+
+public:
+	SeqLock() {
+		T value{};
+		store(value);
+	}
+
+	// Single writer only
+	void store(const T& value) {
+		uint64_t buffer[kWords] = {};
+		std::memcpy(buffer, &value, sizeof(T));
+
+		const uint32_t s = sequence.load(std::memory_order_relaxed);
+		sequence.store(s + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		for (size_t i = 0; i < kWords; ++i) words[i].store(buffer[i], std::memory_order_relaxed);
+		sequence.store(s + 2, std::memory_order_release);
+	}
+
+	// Any thread, returns a value that was stored as a whole
+	T load() const {
+		uint64_t buffer[kWords];
+		uint32_t before, after;
+		do {
+			before = sequence.load(std::memory_order_acquire);
+			for (size_t i = 0; i < kWords; ++i) buffer[i] = words[i].load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			after = sequence.load(std::memory_order_relaxed);
+		} while ((before & 1) || before != after);
+
+		T value;
+		std::memcpy(&value, buffer, sizeof(T));
+		return value;
+	}
+
+private:
+	static constexpr size_t kWords = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	std::atomic<uint32_t> sequence{ 0 };
+	std::atomic<uint64_t> words[kWords];
+};
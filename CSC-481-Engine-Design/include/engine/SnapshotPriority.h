@@ -0,0 +1,60 @@
+#pragma once
+
+#include <engine/Types.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// How much an entity's priority grows each tick it isn't sent. The priority keeps growing until it
+// is, so time since the last send is built in and nothing waits forever.
+struct PriorityWeights {
+	float base = 1.0f;         // every entity, near or far, moving or not
+	float nearby = 4.0f;       // extra for an entity next to the viewer, halved at falloff
+	float falloff = 600.0f;    // px
+	float motion = 2.0f;       // extra per speedScale of speed
+	float speedScale = 500.0f; // px/s
+};
+
+// Something that could go in a viewer's next snapshot
+struct ReplicationCandidate {
+	uint64_t key;         // stable across ticks, the same entity must keep the same key
+	OrderedPair position;
+	OrderedPair velocity; // px/s
+	size_t bytes;         // what it adds to the snapshot
+};
+
+// The PriorityAccumulator class picks what goes in one viewer's snapshots when not everything fits.
+// Every tick each candidate adds its weight to its priority, the highest priorities are sent
+// within the byte budget and start again from zero, and the rest wait with a higher priority
+// next tick. Keep one per viewer. Single thread.
+class PriorityAccumulator {
+public:
+	explicit PriorityAccumulator(const PriorityWeights& weights = PriorityWeights());
+
+	/**
+	 * Picks the candidates to send this tick.
+	 * @param viewer Where the viewer is, nearby entities count for more.
+	 * @param candidates Everything that could be sent, entities missing from it are forgotten.
+	 * @param budgetBytes Bytes available this tick.
+	 * @param picked Replaced with indices into candidates, most important first.
+	 */
+	void select(OrderedPair viewer, const std::vector<ReplicationCandidate>& candidates, size_t budgetBytes,
+		std::vector<int>& picked);
+
+	// Forget every priority, e.g. when the viewer changes
+	void clear();
+
+private:
+	struct Entry {
+		float priority = 0.0f;
+		uint64_t selection = 0; // last select() it was a candidate in
+	};
+
+	float weightOf(OrderedPair viewer, const ReplicationCandidate& candidate) const;
+
+	PriorityWeights weights;
+	std::unordered_map<uint64_t, Entry> entries;
+	std::vector<std::pair<float, int>> order; // reused, priority and candidate index
+	uint64_t selections = 0;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Wait times for one mutex, added to by every thread that locks it through TimedLock
+class LockWaitStats {
+public:
+	void record(uint64_t waitNS);
+
+	// Average and longest wait since the last take, in microseconds, then start over
+	void take(float& avgUs, float& maxUs);
+
+private:
+	std::atomic<uint64_t> count{ 0 };
+	std::atomic<uint64_t> totalNS{ 0 };
+	std::atomic<uint64_t> maxNS{ 0 };
+};
+
+// lock_guard that records how long it waited for the mutex
+template<class Mutex>
+class TimedLock {
+public:
+	TimedLock(Mutex& mutex, LockWaitStats& stats) : mutex(mutex) {
+		const auto start = std::chrono::steady_clock::now();
+		mutex.lock();
+		stats.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count()));
+	}
+	~TimedLock() { mutex.unlock(); }
+	TimedLock(const TimedLock&) = delete;
+	TimedLock& operator=(const TimedLock&) = delete;
+private:
+	Mutex& mutex;
+};
+
+// shared_lock that records how long it waited for the mutex
+template<class Mutex>
+class TimedSharedLock {
+public:
+	TimedSharedLock(Mutex& mutex, LockWaitStats& stats) : mutex(mutex) {
+		const auto start = std::chrono::steady_clock::now();
+		mutex.lock_shared();
+		stats.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - start).count()));
+	}
+	~TimedSharedLock() { mutex.unlock_shared(); }
+	TimedSharedLock(const TimedSharedLock&) = delete;
+	TimedSharedLock& operator=(const TimedSharedLock&) = delete;
+private:
+	Mutex& mutex;
+};
+
+// Tick durations over one reporting window, for percentiles and overrun counts.
+// Room for the window is reserved up front, so recording never allocates. Single thread.
+class TickStats {
+public:
+	// budgetNS is the tick period, ticks that take longer count as overruns
+	TickStats(uint64_t budgetNS, size_t ticksPerWindow);
+
+	void record(uint64_t durationNS);
+
+	// Percentiles of the window in milliseconds (p in 0..1), 0 for an empty window
+	float percentileMs(float p);
+	float maxMs() const;
+	uint32_t overruns() const;
+	size_t count() const;
+
+	// Start the next window
+	void reset();
+
+private:
+	uint64_t budgetNS;
+	std::vector<uint64_t> samples;
+	uint64_t longestNS = 0;
+	uint32_t overrunCount = 0;
+};
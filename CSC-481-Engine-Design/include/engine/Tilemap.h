@@ -0,0 +1,127 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <engine/MappedFile.h>
+#include <engine/Types.h>
+
+// Level file layout, read straight from the mapping (little endian):
+//   TilemapHeader
+//   uint64_t chunkOffsets[chunksX * chunksY]   byte offset of each chunk, 0 for an all empty chunk
+//   uint16_t tiles[chunkSize * chunkSize]      per stored chunk, row major, 0 = no tile
+// tilemap_build writes these from a text level.
+struct TilemapHeader {
+	char magic[8];         // "CSCTMAP"
+	uint32_t version;
+	uint32_t tileSize;     // pixels per tile side in world space
+	uint32_t chunkSize;    // tiles per chunk side
+	uint32_t chunksX;
+	uint32_t chunksY;
+	uint32_t tilesetColumns;
+	uint32_t tilesetRows;
+	char tileset[116];     // texture path, null terminated
+};
+
+// The Tilemap class holds a level made of fixed size chunks of tile ids.
+// Only the chunks around the focus area are kept in memory. A background thread decodes
+// chunks from the mapped level file as the focus moves, and update() swaps them in and drops
+// far ones on the main thread. Collision works on merged solid rects per chunk and drawing on
+// one baked texture per chunk, so no tile ever becomes an Entity.
+class Tilemap {
+public:
+	static constexpr uint32_t kVersion = 1;
+
+	Tilemap() = default;
+	~Tilemap();
+
+	Tilemap(const Tilemap&) = delete;
+	Tilemap& operator=(const Tilemap&) = delete;
+
+	// Map a level file and start the loader thread
+	bool open(const std::string& path);
+
+	// Stop the loader and drop every chunk (call before the renderer is destroyed)
+	void close();
+
+	bool isOpen() const;
+
+	// World area to keep loaded, usually the visible area. Chunks within the load margin of it
+	// are streamed in, chunks past the margin plus one are dropped.
+	void setFocus(const SDL_FRect& area);
+
+	// Chunks kept around the focus on each side
+	void setLoadMargin(int chunks);
+
+	// Main thread: take in chunks the loader finished and drop chunks far from the focus
+	void update();
+
+	// Draw the loaded chunks overlapping view, offset by -view.x/-view.y, scaled by zoom
+	void draw(SDL_Renderer* renderer, const SDL_FRect& view, float zoom = 1.0f);
+
+	// Append the solid rects of loaded chunks overlapping area
+	void query(const SDL_FRect& area, std::vector<SDL_FRect>& out) const;
+
+	// Tile id at a world point, 0 if empty, outside or not loaded
+	uint16_t tileAt(float x, float y) const;
+
+	// World size of the whole level
+	SDL_FRect getBounds() const;
+	float getTileSize() const;
+
+	// Chunks currently in memory
+	size_t residentChunks() const;
+
+private:
+	struct Chunk {
+		int cx = 0;
+		int cy = 0;
+		std::vector<uint16_t> tiles;
+		std::vector<SDL_FRect> solids; // merged runs of tiles, in world space
+		SDL_Texture* texture = nullptr; // baked on first draw
+	};
+
+	// Chunk range covering an area grown by margin chunks, clamped to the level
+	struct ChunkRange {
+		int x0, y0, x1, y1; // inclusive
+		bool contains(int cx, int cy) const { return cx >= x0 && cx <= x1 && cy >= y0 && cy <= y1; }
+	};
+	ChunkRange rangeFor(const SDL_FRect& area, int margin) const;
+
+	void loaderLoop();
+	std::unique_ptr<Chunk> loadChunk(int cx, int cy) const;
+	void bake(SDL_Renderer* renderer, Chunk& chunk);
+	void destroyChunk(Chunk& chunk);
+
+	MappedFile file;
+	const TilemapHeader* header = nullptr;
+	const uint64_t* offsets = nullptr;
+	float tileSize = 0.0f;
+	float chunkWorld = 0.0f;
+
+	// Loaded chunks by cy * chunksX + cx, readers share, update() writes
+	std::vector<std::unique_ptr<Chunk>> resident;
+	mutable std::shared_mutex residentMutex;
+
+	// Loader state: focus, per chunk request flags and finished chunks waiting for update()
+	std::thread loader;
+	std::mutex loaderMutex;
+	std::condition_variable loaderCV;
+	bool stopLoader = false;
+	bool focusChanged = false;
+	SDL_FRect focus{};
+	ChunkRange focusRange{ 0, 0, -1, -1 }; // chunks the loader was last asked for
+	int margin = 1;
+	std::vector<uint8_t> requested;
+	std::vector<std::unique_ptr<Chunk>> finished;
+
+	// Tileset texture, loaded on the first draw
+	SDL_Texture* tileset = nullptr;
+	bool tilesetTried = false;
+};
@@ -1,33 +1,66 @@
-#pragma once
-
-#include <SDL3/SDL.h>
-
-class Timeline {
-public:
-    // Initialize internal tick tracking
-    void init();
-
-    // Update internal time and return scaled deltaTime
-    double update();
-
-    // Set the speed scale, clamped between minSpeed and maxSpeed
-    void setScale(double s);
-    double getScale() const;
-
-    // Pause/unpause the timeline
-    void pause();
-    void resume();
-    bool isPaused() const;
-
-    // Total accumulated game time (scaled)
-    double getAccumulatedTime() const;
-
-private:
-    double timeScale = 1.0;
-    double accumulated = 0.0;
-    Uint64 lastTicks = 0;
-    bool paused = false;
-
-    static constexpr double doubleSpeed = 2.0;
-    static constexpr double halfSpeed = 0.5;
-};
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <cstdint>
+#include <mutex>
+
+// The Timeline class measures time in nanoseconds, scaled and pausable.
+// A timeline without a parent follows SDL_GetTicksNS, a child follows its parent's time,
+// so pausing or scaling a parent carries down to every child (global -> gameplay -> entity).
+// Reading the time is thread safe and doesn't change the timeline, so any number of
+// threads can take their own deltas from one timeline.
+class Timeline {
+public:
+    // The parent must outlive this timeline, null for a root on the real clock
+    explicit Timeline(Timeline* parent = nullptr);
+
+    Timeline(const Timeline&) = delete;
+    Timeline& operator=(const Timeline&) = delete;
+
+    // Restart local time at 0 and the update() baseline
+    void init();
+
+    // Update internal time and return scaled deltaTime in seconds since the last call
+    double update();
+
+    // Local time in nanoseconds (scaled, stops while paused)
+    int64_t getTimeNS() const;
+
+    // Set the speed scale, clamped between minSpeed and maxSpeed
+    void setScale(double s);
+    double getScale() const;
+
+    // Pause/unpause the timeline
+    void pause();
+    void resume();
+    bool isPaused() const;
+
+    // Total accumulated game time (scaled)
+    double getAccumulatedTime() const;
+
+    Timeline* getParent() const;
+
+private:
+    // Parent time, or the real clock for a root
+    int64_t parentTimeNS() const;
+
+    // Local time from the anchors, caller holds mutex
+    int64_t localAt(int64_t parentNow) const;
+
+    // Restart the linear mapping at the current time, so scale and pause changes apply from now on
+    void rebase(int64_t parentNow);
+
+    Timeline* parent;
+    double timeScale = 1.0;
+    bool paused = false;
+
+    // local = anchorLocal + (parent - anchorParent) * timeScale
+    int64_t anchorLocal = 0;
+    int64_t anchorParent = 0;
+    int64_t lastUpdate = 0;
+
+    mutable std::mutex mutex;
+
+    static constexpr double doubleSpeed = 2.0;
+    static constexpr double halfSpeed = 0.5;
+};
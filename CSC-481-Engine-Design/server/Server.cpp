@@ -1,221 +1,838 @@
-#include <zmq.hpp>
-#include <iostream>
-#include <string>
-#include <chrono>
-#include <thread>
-#include <unordered_map>
-#include <sstream>
-#include <mutex>
-#include <atomic>
-#include <vector>
-#include <cmath>
-#include "../include/engine/NetworkTypes.h"
-#include "../include/engine/Types.h"
-
-#define THREADS 1
-
-// Player positions tracked by ID
-std::unordered_map<int, std::pair<float, float>> players;
-std::mutex playersMutex;
-
-// Generic synchronized objects
-struct SyncedObject {
-    OrderedPair position;
-    OrderedPair velocity;
-    int type;  // 0 = platform, 1 = enemy, 2 = powerup, etc.
-    int id;
-};
-
-std::unordered_map<int, SyncedObject> syncedObjects;
-std::mutex objectsMutex;
-
-std::atomic<bool> running{ true };
-
-// Initialize synchronized objects (each game can customize this)
-void initializeSyncedObjects() {
-    std::lock_guard<std::mutex> lock(objectsMutex);
-    
-    // Harrison's moving platform (ID 0)
-    syncedObjects[0] = {{1100.0f, 700.0f}, {150.0f, 0.0f}, 0, 0};
-
-	// Riley's moving orb (ID 1)
-	syncedObjects[1] = { {1920.0f - 128.0f, 0.0f}, {-400.0f, 180.0f}, 1, 1 };
-    
-    // Other team members can add their objects here with different IDs
-    // syncedObjects[1] = {{500.0f, 300.0f}, {0.0f, 100.0f}, 1, 1}; // Example enemy
-    // syncedObjects[2] = {{200.0f, 400.0f}, {50.0f, 0.0f}, 2, 2}; // Example powerup
-}
-
-// Reply handler per client
-void reply_handler(zmq::context_t& context, int clientID) {
-    zmq::socket_t responder(context, zmq::socket_type::rep);
-    int port = 5556 + clientID;
-    responder.bind("tcp://*:" + std::to_string(port));
-    std::cout << "[Server] Listening for client " << clientID << " on port " << port << "\n";
-
-    while (running) {
-        zmq::message_t request;
-        if (!responder.recv(request, zmq::recv_flags::none)) continue;
-
-        std::string req(static_cast<char*>(request.data()), request.size());
-        std::istringstream iss(req);
-        std::string cmd; int id, tick; uint32_t actions; float x, y;
-        if (iss >> cmd >> id >> tick >> actions >> x >> y) {
-            if (cmd == "CMD") {
-                std::lock_guard<std::mutex> lock(playersMutex);
-                players[id] = { x, y };
-            }
-        }
-
-        static const std::string ack = "Acknowledged";
-        responder.send(zmq::buffer(ack), zmq::send_flags::none);
-    }
-}
-
-// Publisher handler sends snapshots to clients
-void pub_handler(zmq::context_t& context) {
-    zmq::socket_t publisher(context, zmq::socket_type::pub);
-    publisher.bind("tcp://*:5555");
-    std::cout << "[Server] Publishing updates on tcp://*:5555\n";
-
-    // Initialize synced objects
-    initializeSyncedObjects();
-
-    int tick = 0;
-    while (running) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(33));
-        ++tick;
-
-        // Update all synchronized objects
-        {
-            std::lock_guard<std::mutex> lock(objectsMutex);
-            for (auto& [id, obj] : syncedObjects) {
-                if (obj.type == 0) { // Platform logic - Harrison's moving platform
-                    obj.position.x += obj.velocity.x * 0.033f;
-                    
-                    // Platform boundaries
-                    if (obj.position.x <= 1000.0f) {
-                        obj.position.x = 1000.0f;
-                        obj.velocity.x = 150.0f;
-                    }
-                    else if (obj.position.x + 200.0f >= 1500.0f) {
-                        obj.position.x = 1500.0f - 200.0f;
-                        obj.velocity.x = -150.0f;
-                    }
-				}
-				else if (obj.type == 1) {
-					// ORB: integrate velocity
-					obj.position.x += obj.velocity.x * 0.033f;
-					obj.position.y += obj.velocity.y * 0.033f;
-
-					// Respawn when fully off left or below bottom
-					if (obj.position.x + 128.0f < 0.0f || obj.position.y > 1080.0f) {
-						obj.position.x = 1920.0 - 128.0f;
-						obj.position.y = 0.0f;
-					}
-				}
-                // Add logic for other object types here
-                // else if (obj.type == 1) { // Enemy logic }
-                // else if (obj.type == 2) { // Powerup logic }
-            }
-        }
-
-        // Build snapshot: SNAP <tick> <numPlayers> <numObjects> [id x y]... [objId objType objX objY]...
-        std::ostringstream oss;
-        oss << "SNAP " << tick << " ";
-
-        // Copy players safely
-        std::vector<std::tuple<int, float, float>> playersCopy;
-        {
-            std::lock_guard<std::mutex> lock(playersMutex);
-            playersCopy.reserve(players.size());
-            for (const auto& kv : players) {
-                playersCopy.emplace_back(kv.first, kv.second.first, kv.second.second);
-            }
-        }
-
-        // Sort players by ID
-        std::sort(playersCopy.begin(), playersCopy.end(),
-            [](const auto& a, const auto& b) { return std::get<0>(a) < std::get<0>(b); });
-
-        // Output counts
-        oss << playersCopy.size() << " " << syncedObjects.size() << " ";
-
-        // Output players
-        for (const auto& p : playersCopy) {
-            oss << std::get<0>(p) << " " << std::get<1>(p) << " " << std::get<2>(p) << " ";
-        }
-
-        // Output synchronized objects
-        {
-            std::lock_guard<std::mutex> lock(objectsMutex);
-            for (const auto& [id, obj] : syncedObjects) {
-                oss << obj.id << " " << obj.type << " " << obj.position.x << " " << obj.position.y << " ";
-            }
-        }
-
-        const std::string snap = oss.str();
-        publisher.send(zmq::buffer(snap), zmq::send_flags::none);
-    }
-}
-
-// Thread for synchronized objects updates
-void objects_thread_func() {
-    using namespace std::chrono;
-    auto last = steady_clock::now();
-
-    while (running) {
-        auto now = steady_clock::now();
-        duration<float> delta = now - last;
-        last = now;
-
-        {
-            std::lock_guard<std::mutex> lock(objectsMutex);
-            for (auto& [id, obj] : syncedObjects) {
-                if (obj.type == 0) { // Platform logic
-                    obj.position.x += obj.velocity.x * delta.count();
-                    
-                    // Platform boundaries
-                    if (obj.position.x <= 1000.0f) {
-                        obj.position.x = 1000.0f;
-                        obj.velocity.x = 150.0f;
-                    }
-                    else if (obj.position.x + 200.0f >= 1500.0f) {
-                        obj.position.x = 1500.0f - 200.0f;
-                        obj.velocity.x = -150.0f;
-                    }
-                }
-                // Add logic for other object types here
-            }
-        }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(16));
-    }
-}
-
-int main() {
-    zmq::context_t context(THREADS);
-
-    // Start objects update thread
-    std::thread objectsThread(objects_thread_func);
-
-    // Publisher thread for world snapshots
-    std::thread pubThread(pub_handler, std::ref(context));
-
-    // Reply threads for clients
-    std::thread rep0(reply_handler, std::ref(context), 0);
-    std::thread rep1(reply_handler, std::ref(context), 1);
-    std::thread rep2(reply_handler, std::ref(context), 2);
-
-    // Wait for threads to finish
-    pubThread.join();
-    rep0.join();
-    rep1.join();
-    rep2.join();
-
-    // Stop objects thread
-    running = false;
-    objectsThread.join();
-
-    return 0;
-}
\ No newline at end of file
+#include <zmq.hpp>
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <unordered_map>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <queue>
+#include <memory>
+#include <atomic>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <cstdlib>
+#include <engine/NetworkTypes.h>
+#include <engine/Types.h>
+#include <engine/Protocol.h>
+#include <engine/Recorder.h>
+#include <engine/Scene.h>
+#include <engine/Telemetry.h>
+#include <engine/SeqLock.h>
+#include <engine/PositionHistory.h>
+#include <engine/Collision.h>
+#include <engine/SnapshotPriority.h>
+
+#define THREADS 1
+
+using Clock = std::chrono::steady_clock;
+
+const std::chrono::milliseconds TICK_PERIOD(33);
+const float TICK_DT = 0.033f;
+const int PLAYER_TIMEOUT_TICKS = 90; // about 3 seconds at 33 ms per tick
+const int ROOM_IDLE_TICKS = 300;     // a room with no players closes after about 10 seconds
+const int MAX_ROOM_PLAYERS = 16;     // command slots per room
+const int HISTORY_TICKS = 32;        // how far back hits are checked, about a second
+const OrderedPair PLAYER_SIZE = { 64.0f, 64.0f };
+const int DODGE_TICKS = static_cast<int>(HAZARD_DODGE_SECONDS / TICK_DT); // 90 at 33 ms per tick
+
+// What each part of a partial snapshot costs against a player's budget, about as long as its text
+const size_t PARTIAL_HEADER_BYTES = 24;
+const size_t PLAYER_ENTRY_BYTES = 24;
+const size_t OBJECT_ENTRY_BYTES = 24;
+const size_t ROSTER_ENTRY_BYTES = 4;
+const uint64_t OBJECT_KEY = 1ull << 32; // priority keys: player IDs as they are, objects above
+
+// Generic synchronized objects
+struct SyncedObject {
+    OrderedPair position;
+    OrderedPair velocity;
+    int type;  // 0 = platform, 1 = enemy, 2 = powerup, etc.
+    int id;
+    OrderedPair spawn;  // where it starts and respawns
+    OrderedPair size;
+    float minX, maxX;   // patrol range for platforms
+};
+
+// Latest command from one player, and the room tick it arrived in
+struct PlayerSlot {
+    int clientId = -1;   // -1 for a free slot
+    int lastSeen = 0;
+    int commandTick = 0;
+    uint32_t actions = 0;
+    float x = 0.0f;
+    float y = 0.0f;
+    int seenTick = -1;   // newest snapshot the player had applied
+    int dodgeUntil = 0;  // room tick the player's dodge ends
+};
+
+// Hazard hits for one slot, kept by the room tick
+struct PlayerHits {
+    int clientId = -1;
+    int hits = 0;
+    int hitTick = -1;        // snapshot that first reported the last hit
+    int checkedCommand = -1; // command tick last checked, so each command is checked once
+};
+
+// One player as sent in a snapshot
+struct LivePlayer {
+    int id;
+    OrderedPair position;
+    int hits;
+    int slot;
+};
+
+// One match. Each room has its own players, objects and tick, and is ticked by whichever
+// pool thread is free when it comes due.
+struct Room {
+    int id = 0;
+
+    // Players, one slot each. Only the network thread writes a slot and the tick reads them
+    // without locks, so taking commands never waits on the simulation or on other players.
+    SeqLock<PlayerSlot> slots[MAX_ROOM_PLAYERS];
+
+    // Which slot each client writes, network thread only (the replay thread in --replay)
+    std::unordered_map<int, int> slotOf;
+    PlayerSlot written[MAX_ROOM_PLAYERS]; // last value stored in each slot
+
+    std::unordered_map<int, SyncedObject> syncedObjects;
+    std::mutex objectsMutex;
+
+    // Where objects and players were on recent ticks, room tick only. Hits are checked against
+    // the objects each client saw, players are kept for checks between players.
+    std::unique_ptr<PositionHistory> objectHistory;
+    std::unique_ptr<PositionHistory> playerHistory;
+    PlayerHits hits[MAX_ROOM_PLAYERS];
+
+    // Budgeted snapshots (--client-kbps): what each player has been waiting for, and its topic
+    PriorityAccumulator priorities[MAX_ROOM_PLAYERS];
+    std::string playerTopics[MAX_ROOM_PLAYERS];
+    std::vector<ReplicationCandidate> candidates; // reused while picking
+    std::vector<int> candidateSources;            // livePlayers index, or -1 - syncedObjects index
+    std::vector<int> picked;
+    WorldSnapshot partial;
+    std::string partialMessage;
+
+    std::atomic<int> tick{ 0 };
+    int idleTicks = 0;
+    Clock::time_point deadline;  // when the next tick is due
+
+    std::string topic;           // snapshot topic frame
+    std::string snapshot;        // reused message buffer
+    WorldSnapshot scratch;       // reused while building the snapshot
+    std::vector<LivePlayer> livePlayers; // reused, players sorted by ID
+};
+
+// Open rooms by ID. Shared for lookups, exclusive to open or close one.
+std::unordered_map<int, std::unique_ptr<Room>> rooms;
+std::shared_mutex roomsMutex;
+int maxRooms = 256;
+
+// Objects every room starts with, loaded once from the scene
+std::vector<SyncedObject> levelObjects;
+
+std::atomic<bool> running{ true };
+
+// Snapshot budget for each player in kbit/s, 0 sends everyone the whole room (--client-kbps)
+float clientBudgetKbps = 0.0f;
+
+// Session log of one room's snapshots and commands (--record, --record-room)
+Recorder sessionRecorder;
+int recordRoom = 0;
+
+// Scene the synced objects are loaded from (--scene)
+std::string scenePath = "assets/level1.scene";
+
+// Snapshots go out on basePort, commands come in on basePort + 1 (--port)
+int basePort = 5555;
+
+// Telemetry: waits on the room locks, traffic, tick times, and where stats are published (--telemetry)
+LockWaitStats roomsLockStats;
+LockWaitStats objectsLockStats;
+std::atomic<uint64_t> commandsReceived{ 0 };
+std::atomic<uint64_t> snapshotBytes{ 0 };
+std::string telemetryEndpoint = "tcp://127.0.0.1:5570";
+const std::chrono::seconds TELEMETRY_PERIOD(1);
+std::unique_ptr<TickStats> tickStats; // sized for maxRooms once the options are read
+std::mutex tickStatsMutex;
+
+// Hands rooms to pool threads in deadline order. A thread takes the room that is due
+// soonest, ticks it, and puts it back for its next deadline.
+class RoomScheduler {
+public:
+    void add(Room* room) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push({ room->deadline, room });
+        }
+        cv.notify_one();
+    }
+
+    // Blocks until a room is due, null once stopped
+    Room* next() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (queue.empty()) {
+                cv.wait(lock);
+            }
+            else if (queue.top().when > Clock::now()) {
+                cv.wait_until(lock, queue.top().when);
+            }
+            else {
+                Room* room = queue.top().room;
+                queue.pop();
+                return room;
+            }
+        }
+        return nullptr;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        cv.notify_all();
+    }
+
+private:
+    struct Due {
+        Clock::time_point when;
+        Room* room;
+        bool operator>(const Due& other) const { return when > other.when; }
+    };
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> queue;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+RoomScheduler scheduler;
+
+// Load the level's objects from the scene's object records, so a new level
+// only needs a new scene file
+void loadLevelObjects() {
+    levelObjects.clear();
+
+    Scene scene;
+    if (scene.open(scenePath)) {
+        for (uint32_t i = 0; i < scene.objectCount(); ++i) {
+            const SceneObject& o = scene.objects()[i];
+            levelObjects.push_back({ {o.x, o.y}, {o.vx, o.vy}, o.type, o.id, {o.x, o.y}, {o.w, o.h}, o.minX, o.maxX });
+        }
+        std::cout << "[Server] Loaded " << scene.objectCount() << " objects from " << scenePath << "\n";
+        return;
+    }
+
+    // No scene, fall back to the original objects
+    std::cout << "[Server] Using built-in objects\n";
+
+    // Harrison's moving platform (ID 0)
+    levelObjects.push_back({ {1100.0f, 700.0f}, {150.0f, 0.0f}, 0, 0, {1100.0f, 700.0f}, {200.0f, 32.0f}, 1000.0f, 1500.0f });
+
+	// Riley's moving orb (ID 1)
+	levelObjects.push_back({ {1920.0f - 128.0f, 0.0f}, {-400.0f, 180.0f}, 1, 1, {1920.0f - 128.0f, 0.0f}, {128.0f, 128.0f}, 0.0f, 0.0f });
+}
+
+// A fresh room with the level's objects at their spawn points
+std::unique_ptr<Room> makeRoom(int id) {
+    std::unique_ptr<Room> room(new Room());
+    room->id = id;
+    room->topic = Protocol::roomTopic(id);
+    for (const SyncedObject& obj : levelObjects) {
+        room->syncedObjects[obj.id] = obj;
+    }
+    room->objectHistory.reset(new PositionHistory(HISTORY_TICKS, static_cast<int>(levelObjects.size())));
+    room->playerHistory.reset(new PositionHistory(HISTORY_TICKS, MAX_ROOM_PLAYERS));
+    return room;
+}
+
+// True if a slot's player has stopped sending commands
+bool isStale(const PlayerSlot& slot, int tick) {
+    return tick - slot.lastSeen > PLAYER_TIMEOUT_TICKS;
+}
+
+/**
+ * Stores a command in its player's slot. A new player takes a free slot, or the slot of a
+ * player who timed out. Writer side only: the network thread, or the replay loop.
+ * @param room The room.
+ * @param cmd The command.
+ * @param tick The room tick it arrived in.
+ * @return false if the room is full.
+ */
+bool applyCommand(Room& room, const ClientCommand& cmd, int tick) {
+    auto it = room.slotOf.find(cmd.clientId);
+    if (it == room.slotOf.end()) {
+        int free = -1;
+        for (int i = 0; i < MAX_ROOM_PLAYERS && free < 0; ++i) {
+            if (room.written[i].clientId < 0 || isStale(room.written[i], tick)) free = i;
+        }
+        if (free < 0) return false;
+        if (room.written[free].clientId >= 0) room.slotOf.erase(room.written[free].clientId);
+        it = room.slotOf.emplace(cmd.clientId, free).first;
+    }
+
+    PlayerSlot& slot = room.written[it->second];
+    slot.clientId = cmd.clientId;
+    slot.lastSeen = tick;
+    slot.commandTick = cmd.tick;
+    slot.actions = cmd.actions;
+    slot.x = cmd.x;
+    slot.y = cmd.y;
+    slot.seenTick = cmd.seenTick;
+    if ((cmd.actions & HAZARD_DODGE_ACTION) && tick >= slot.dodgeUntil) slot.dodgeUntil = tick + DODGE_TICKS;
+    room.slots[it->second].store(slot);
+    return true;
+}
+
+// Frees the slots of players that timed out, writer side only. Returns the players left.
+int releaseIdleSlots(Room& room) {
+    const int tick = room.tick.load();
+    int live = 0;
+    for (int i = 0; i < MAX_ROOM_PLAYERS; ++i) {
+        PlayerSlot& slot = room.written[i];
+        if (slot.clientId < 0) continue;
+        if (!isStale(slot, tick)) {
+            ++live;
+            continue;
+        }
+        std::cout << "[Server] Player " << slot.clientId << " timed out of room " << room.id << "\n";
+        room.slotOf.erase(slot.clientId);
+        slot = PlayerSlot();
+        room.slots[i].store(slot);
+    }
+    return live;
+}
+
+/**
+ * Routes a command to its room, opening the room on its first command.
+ * @param cmd The decoded command.
+ * @param tick Receives the room tick the command landed in.
+ * @return false if the room doesn't exist and the server is at maxRooms.
+ */
+bool routeCommand(const ClientCommand& cmd, int& tick) {
+    {
+        TimedSharedLock<std::shared_mutex> lock(roomsMutex, roomsLockStats); // exclusive only while a room opens or closes
+        auto it = rooms.find(cmd.room);
+        if (it != rooms.end()) {
+            tick = it->second->tick.load();
+            return applyCommand(*it->second, cmd, tick);
+        }
+    }
+
+    TimedLock<std::shared_mutex> lock(roomsMutex, roomsLockStats);
+    auto it = rooms.find(cmd.room);
+    if (it == rooms.end()) {
+        if (static_cast<int>(rooms.size()) >= maxRooms) return false;
+        it = rooms.emplace(cmd.room, makeRoom(cmd.room)).first;
+        it->second->deadline = Clock::now() + TICK_PERIOD;
+        scheduler.add(it->second.get());
+        std::cout << "[Server] Opened room " << cmd.room << " (" << rooms.size() << " open)\n";
+    }
+    tick = it->second->tick.load();
+    return applyCommand(*it->second, cmd, tick);
+}
+
+// Advance every synchronized object in a room by one fixed step
+void stepSyncedObjects(Room& room, float dt) {
+    TimedLock<std::mutex> lock(room.objectsMutex, objectsLockStats);
+    for (auto& [id, obj] : room.syncedObjects) {
+        if (obj.type == 0) { // Platform logic - Harrison's moving platform
+            obj.position.x += obj.velocity.x * dt;
+
+            // Platform boundaries
+            const float speed = std::fabs(obj.velocity.x);
+            if (obj.position.x <= obj.minX) {
+                obj.position.x = obj.minX;
+                obj.velocity.x = speed;
+            }
+            else if (obj.position.x + obj.size.x >= obj.maxX) {
+                obj.position.x = obj.maxX - obj.size.x;
+                obj.velocity.x = -speed;
+            }
+        }
+        else if (obj.type == 1) {
+            // ORB: integrate velocity
+            obj.position.x += obj.velocity.x * dt;
+            obj.position.y += obj.velocity.y * dt;
+
+            // Respawn when fully off left or below bottom
+            if (obj.position.x + obj.size.x < 0.0f || obj.position.y > 1080.0f) {
+                obj.position = obj.spawn;
+            }
+        }
+        // Add logic for other object types here
+        // else if (obj.type == 2) { // Powerup logic }
+    }
+}
+
+// Remember where every object is on this tick
+void recordObjects(Room& room, int tick) {
+    TimedLock<std::mutex> lock(room.objectsMutex, objectsLockStats);
+    room.objectHistory->beginTick(tick);
+    for (const auto& [id, obj] : room.syncedObjects) {
+        room.objectHistory->record(obj.id, { obj.position.x, obj.position.y, obj.size.x, obj.size.y });
+    }
+}
+
+/**
+ * Checks a player's newest command against the orbs where that client saw them. The orbs are
+ * rewound to the snapshot the client had on screen, so whether it was hit doesn't depend on
+ * its latency. Room tick only.
+ * @param room The room.
+ * @param slot The player's slot as read this tick.
+ * @param track The player's hits, updated on a hit.
+ * @param tick The tick being built, its snapshot is the first to report a hit.
+ */
+void checkHazardHits(Room& room, const PlayerSlot& slot, PlayerHits& track, int tick) {
+    if (slot.seenTick < 0 || slot.commandTick == track.checkedCommand) return; // nothing on screen yet, or already checked
+    track.checkedCommand = slot.commandTick;
+
+    // Until the client has seen its last hit it hasn't respawned, and would be hit again
+    if (slot.seenTick < track.hitTick || slot.lastSeen < slot.dodgeUntil) return;
+
+    const int seen = room.objectHistory->clamp(slot.seenTick);
+    const SDL_FRect player = { slot.x, slot.y, PLAYER_SIZE.x, PLAYER_SIZE.y };
+    for (const SyncedObject& obj : levelObjects) {
+        SDL_FRect orb;
+        if (obj.type != 1 || !room.objectHistory->find(seen, obj.id, orb)) continue;
+        if (Collision::checkCollision(player, orb)) {
+            ++track.hits;
+            track.hitTick = tick;
+            std::cout << "[Server] Player " << slot.clientId << " hit in room " << room.id << " at tick " << seen
+                      << " (" << tick - seen << " ticks back)\n";
+            return;
+        }
+    }
+}
+
+// Build a room's snapshot message for a tick into room.snapshot
+void buildSnapshot(Room& room, int tick) {
+    WorldSnapshot& snapshot = room.scratch;
+    snapshot.tick = tick;
+    snapshot.playerIds.clear();
+    snapshot.playerPositions.clear();
+    snapshot.syncedObjects.clear();
+
+    snapshot.playerHits.clear();
+
+    // Read every slot without locking, players still sending are checked for hits and sent sorted by ID
+    room.livePlayers.clear();
+    room.playerHistory->beginTick(tick);
+    for (int i = 0; i < MAX_ROOM_PLAYERS; ++i) {
+        const PlayerSlot slot = room.slots[i].load();
+        PlayerHits& track = room.hits[i];
+        if (track.clientId != slot.clientId) { // slot changed hands
+            track = PlayerHits{ slot.clientId };
+            room.priorities[i].clear();
+            room.playerTopics[i] = Protocol::playerTopic(room.id, slot.clientId);
+        }
+        if (slot.clientId < 0 || isStale(slot, tick)) continue;
+
+        checkHazardHits(room, slot, track, tick);
+        room.playerHistory->record(slot.clientId, { slot.x, slot.y, PLAYER_SIZE.x, PLAYER_SIZE.y });
+        room.livePlayers.push_back({ slot.clientId, { slot.x, slot.y }, track.hits, i });
+    }
+    std::sort(room.livePlayers.begin(), room.livePlayers.end(),
+        [](const LivePlayer& a, const LivePlayer& b) { return a.id < b.id; });
+    for (const LivePlayer& player : room.livePlayers) {
+        snapshot.playerIds.push_back(player.id);
+        snapshot.playerPositions.push_back(player.position);
+        snapshot.playerHits.push_back(player.hits);
+    }
+
+    // Copy synchronized objects
+    {
+        TimedLock<std::mutex> lock(room.objectsMutex, objectsLockStats);
+        for (const auto& [id, obj] : room.syncedObjects) {
+            snapshot.syncedObjects.push_back({ obj.id, obj.type, obj.position });
+        }
+    }
+
+    Protocol::encodeSnapshot(snapshot, room.snapshot);
+}
+
+// Velocity over the last tick from the history, zero if either tick is missing
+OrderedPair velocityOf(const PositionHistory& history, int id, int tick) {
+    SDL_FRect now, before;
+    if (!history.find(tick, id, now) || !history.find(tick - 1, id, before)) return {};
+    return { (now.x - before.x) / TICK_DT, (now.y - before.y) / TICK_DT };
+}
+
+/**
+ * Sends each player a partial snapshot that fits its bandwidth budget. What matters most to that
+ * player (near, fast, or not sent for a while) goes first, the rest wait with a higher priority.
+ * A player's own entry, the roster and the hazards always go. Room tick only, after buildSnapshot.
+ * @param room The room.
+ * @param tick The tick.
+ * @param outbound PUSH socket to the network thread.
+ */
+void sendPlayerSnapshots(Room& room, int tick, zmq::socket_t& outbound) {
+    const WorldSnapshot& full = room.scratch;
+    const size_t budget = static_cast<size_t>(clientBudgetKbps * 1000.0f / 8.0f * TICK_DT);
+    // Hazards go outside the budget: hits are judged against the snapshot's tick, so a stale orb would
+    // be judged where it was, not where the client drew it
+    size_t hazards = 0;
+    for (const SyncedObjectData& obj : full.syncedObjects) {
+        if (obj.type == 1) ++hazards;
+    }
+    const size_t fixed = PARTIAL_HEADER_BYTES + ROSTER_ENTRY_BYTES * room.livePlayers.size() + PLAYER_ENTRY_BYTES +
+        OBJECT_ENTRY_BYTES * hazards;
+
+    WorldSnapshot& partial = room.partial;
+    partial.tick = tick;
+    partial.partial = true;
+    partial.roster = full.playerIds;
+
+    for (const LivePlayer& viewer : room.livePlayers) {
+        // Everything but the viewer itself
+        room.candidates.clear();
+        room.candidateSources.clear();
+        for (size_t i = 0; i < room.livePlayers.size(); ++i) {
+            const LivePlayer& other = room.livePlayers[i];
+            if (other.id == viewer.id) continue;
+            room.candidates.push_back({ static_cast<uint32_t>(other.id), other.position,
+                velocityOf(*room.playerHistory, other.id, tick), PLAYER_ENTRY_BYTES });
+            room.candidateSources.push_back(static_cast<int>(i));
+        }
+        for (size_t i = 0; i < full.syncedObjects.size(); ++i) {
+            const SyncedObjectData& obj = full.syncedObjects[i];
+            if (obj.type == 1) continue;
+            room.candidates.push_back({ OBJECT_KEY | static_cast<uint32_t>(obj.id), obj.position,
+                velocityOf(*room.objectHistory, obj.id, tick), OBJECT_ENTRY_BYTES });
+            room.candidateSources.push_back(-1 - static_cast<int>(i));
+        }
+        room.priorities[viewer.slot].select(viewer.position, room.candidates, budget > fixed ? budget - fixed : 0, room.picked);
+
+        partial.playerIds.assign(1, viewer.id);
+        partial.playerPositions.assign(1, viewer.position);
+        partial.playerHits.assign(1, viewer.hits);
+        partial.syncedObjects.clear();
+        for (const SyncedObjectData& obj : full.syncedObjects) {
+            if (obj.type == 1) partial.syncedObjects.push_back(obj);
+        }
+        for (int index : room.picked) {
+            const int source = room.candidateSources[index];
+            if (source >= 0) {
+                const LivePlayer& other = room.livePlayers[source];
+                partial.playerIds.push_back(other.id);
+                partial.playerPositions.push_back(other.position);
+                partial.playerHits.push_back(other.hits);
+            }
+            else {
+                partial.syncedObjects.push_back(full.syncedObjects[-1 - source]);
+            }
+        }
+
+        Protocol::encodeSnapshot(partial, room.partialMessage);
+        outbound.send(zmq::buffer(room.playerTopics[viewer.slot]), zmq::send_flags::sndmore);
+        outbound.send(zmq::buffer(room.partialMessage), zmq::send_flags::none);
+        snapshotBytes.fetch_add(room.partialMessage.size(), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Runs one tick of a room and sends its snapshot to the network thread.
+ * @param room The room, only this thread touches its objects during the tick.
+ * @param outbound PUSH socket to the network thread.
+ * @return false once the room has been empty long enough to close.
+ */
+bool tickRoom(Room& room, zmq::socket_t& outbound) {
+    const int tick = ++room.tick;
+
+    // Update all synchronized objects
+    stepSyncedObjects(room, TICK_DT);
+    recordObjects(room, tick);
+    buildSnapshot(room, tick); // leaves out players that timed out
+
+    // With a budget every player gets its own snapshot, the full one is still what gets recorded
+    if (clientBudgetKbps > 0.0f) {
+        sendPlayerSnapshots(room, tick, outbound);
+    }
+    else {
+        outbound.send(zmq::buffer(room.topic), zmq::send_flags::sndmore);
+        outbound.send(zmq::buffer(room.snapshot), zmq::send_flags::none);
+        snapshotBytes.fetch_add(room.snapshot.size(), std::memory_order_relaxed);
+    }
+
+    if (room.id == recordRoom) {
+        sessionRecorder.record(RecordType::Snapshot, tick, room.snapshot);
+        sessionRecorder.flush();
+    }
+
+    room.idleTicks = room.scratch.playerIds.empty() ? room.idleTicks + 1 : 0;
+    return room.idleTicks < ROOM_IDLE_TICKS;
+}
+
+// Closes an idle room, unless a player joined since its last tick.
+// With roomsMutex held exclusively the network thread can't be writing its slots.
+void closeRoom(Room* room) {
+    TimedLock<std::shared_mutex> lock(roomsMutex, roomsLockStats);
+    const int tick = room->tick.load();
+    for (const PlayerSlot& slot : room->written) {
+        if (slot.clientId >= 0 && !isStale(slot, tick)) {
+            room->idleTicks = 0;
+            room->deadline = Clock::now() + TICK_PERIOD;
+            scheduler.add(room);
+            return;
+        }
+    }
+    const int id = room->id;
+    rooms.erase(id);
+    std::cout << "[Server] Closed idle room " << id << " (" << rooms.size() << " open)\n";
+}
+
+// Pool thread: ticks whichever room is due next
+void roomWorker(zmq::context_t& context) {
+    zmq::socket_t outbound(context, zmq::socket_type::push);
+    outbound.connect("inproc://snapshots");
+
+    while (Room* room = scheduler.next()) {
+        const auto start = Clock::now();
+        const bool open = tickRoom(*room, outbound);
+        const auto end = Clock::now();
+        {
+            std::lock_guard<std::mutex> lock(tickStatsMutex);
+            tickStats->record(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+        }
+
+        if (!open) {
+            closeRoom(room);
+            continue;
+        }
+        // Next deadline on the fixed schedule, or from now if the room fell a whole tick behind
+        room->deadline += TICK_PERIOD;
+        if (room->deadline < end) room->deadline = end + TICK_PERIOD;
+        scheduler.add(room);
+    }
+}
+
+// Sends the last second's stats on the telemetry socket
+void publishStats(zmq::socket_t& telemetry, float seconds, std::string& message) {
+    ServerStats stats;
+    {
+        TimedSharedLock<std::shared_mutex> lock(roomsMutex, roomsLockStats);
+        stats.rooms = static_cast<int>(rooms.size());
+        for (auto& [id, room] : rooms) {
+            stats.clients += releaseIdleSlots(*room); // this is the slot writer's thread
+            stats.tick = std::max(stats.tick, room->tick.load());
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(tickStatsMutex);
+        stats.tickP50Ms = tickStats->percentileMs(0.50f);
+        stats.tickP95Ms = tickStats->percentileMs(0.95f);
+        stats.tickP99Ms = tickStats->percentileMs(0.99f);
+        stats.tickMaxMs = tickStats->maxMs();
+        stats.overruns = tickStats->overruns();
+        tickStats->reset();
+    }
+    stats.commandsPerSec = commandsReceived.exchange(0, std::memory_order_relaxed) / seconds;
+    stats.snapshotBytesPerSec = snapshotBytes.exchange(0, std::memory_order_relaxed) / seconds;
+    roomsLockStats.take(stats.roomsLockAvgUs, stats.roomsLockMaxUs);
+    objectsLockStats.take(stats.objectsLockAvgUs, stats.objectsLockMaxUs);
+
+    Protocol::encodeStats(stats, message);
+    telemetry.send(zmq::buffer(message), zmq::send_flags::dontwait);
+}
+
+/**
+ * Network thread: the only thread touching the client facing sockets. Commands from every
+ * client arrive on one ROUTER socket and are routed to their room, snapshots from the pool
+ * threads arrive on the inproc PULL socket and are published with their room's topic.
+ * @param context The ZeroMQ context.
+ * @param inbound PULL socket bound to inproc://snapshots before the pool started.
+ */
+void networkThread(zmq::context_t& context, zmq::socket_t& inbound) {
+    zmq::socket_t commands(context, zmq::socket_type::router);
+    commands.bind("tcp://*:" + std::to_string(basePort + 1));
+    std::cout << "[Server] Taking commands on tcp://*:" << basePort + 1 << "\n";
+
+    zmq::socket_t publisher(context, zmq::socket_type::pub);
+    publisher.bind("tcp://*:" + std::to_string(basePort));
+    std::cout << "[Server] Publishing updates on tcp://*:" << basePort << "\n";
+
+    // Stats go out on their own socket so monitoring never shares a queue with players
+    zmq::socket_t telemetry(context, zmq::socket_type::pub);
+    telemetry.bind(telemetryEndpoint);
+    std::cout << "[Server] Publishing telemetry on " << telemetryEndpoint << "\n";
+
+    static const std::string ack = "Acknowledged";
+    static const std::string full = "Full";
+    std::string statsMessage;
+    auto windowStart = Clock::now();
+
+    while (running) {
+        zmq::pollitem_t items[] = {
+            { commands.handle(), 0, ZMQ_POLLIN, 0 },
+            { inbound.handle(), 0, ZMQ_POLLIN, 0 },
+        };
+        zmq::poll(items, 2, std::chrono::milliseconds(100));
+
+        // REQ envelope: client identity, empty delimiter, command
+        if (items[0].revents & ZMQ_POLLIN) {
+            zmq::message_t identity, delimiter, request;
+            if (commands.recv(identity, zmq::recv_flags::none) && commands.recv(delimiter, zmq::recv_flags::none) &&
+                commands.recv(request, zmq::recv_flags::none)) {
+                bool accepted = true;
+                ClientCommand cmd;
+                int tick = 0;
+                if (Protocol::decodeCommand(static_cast<const char*>(request.data()), request.size(), cmd)) {
+                    accepted = routeCommand(cmd, tick);
+                    commandsReceived.fetch_add(1, std::memory_order_relaxed);
+                    if (accepted && cmd.room == recordRoom) {
+                        sessionRecorder.record(RecordType::Command, tick, request.data(), request.size());
+                    }
+                }
+                commands.send(identity, zmq::send_flags::sndmore);
+                commands.send(zmq::message_t(), zmq::send_flags::sndmore);
+                commands.send(zmq::buffer(accepted ? ack : full), zmq::send_flags::none);
+            }
+        }
+
+        // Forward every finished snapshot, topic frame first
+        if (items[1].revents & ZMQ_POLLIN) {
+            zmq::message_t topic, snapshot;
+            while (inbound.recv(topic, zmq::recv_flags::dontwait)) {
+                if (!inbound.recv(snapshot, zmq::recv_flags::none)) break;
+                publisher.send(topic, zmq::send_flags::sndmore);
+                publisher.send(snapshot, zmq::send_flags::none);
+            }
+        }
+
+        const auto now = Clock::now();
+        if (now - windowStart >= TELEMETRY_PERIOD) {
+            publishStats(telemetry, std::chrono::duration<float>(now - windowStart).count(), statsMessage);
+            windowStart = now;
+        }
+    }
+}
+
+// Replays a recorded session through the simulation at full speed.
+// Commands are applied in recorded order and every recorded snapshot tick is
+// re-simulated, so the rebuilt snapshots can be checked against the capture.
+int runReplay(const std::string& path) {
+    Replay replay;
+    if (!replay.open(path)) return 1;
+
+    loadLevelObjects();
+    std::unique_ptr<Room> room = makeRoom(recordRoom);
+
+    int tick = 0;
+    size_t commands = 0, snapshots = 0, mismatches = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    ReplayRecord record;
+    while (replay.next(record)) {
+        if (record.type == RecordType::Command) {
+            ClientCommand cmd;
+            if (Protocol::decodeCommand(record.data, record.size, cmd)) {
+                applyCommand(*room, cmd, record.tick);
+                ++commands;
+            }
+        }
+        else if (record.type == RecordType::Snapshot) {
+            // Catch the simulation up to the recorded tick
+            while (tick < record.tick) {
+                ++tick;
+                stepSyncedObjects(*room, TICK_DT);
+                recordObjects(*room, tick);
+            }
+            buildSnapshot(*room, tick);
+            const std::string& snap = room->snapshot;
+            if (snap.size() != record.size || snap.compare(0, snap.size(), record.data, record.size) != 0) {
+                if (mismatches == 0) {
+                    std::cout << "[Replay] First divergence at tick " << tick << "\n"
+                              << "  recorded: " << std::string(record.data, record.size) << "\n"
+                              << "  replayed: " << snap << "\n";
+                }
+                ++mismatches;
+            }
+            ++snapshots;
+        }
+    }
+
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "[Replay] " << snapshots << " snapshots, " << commands << " commands, "
+              << mismatches << " divergent snapshots in " << elapsed.count() << " ms\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    // Level to serve: --scene <file>, must come before --replay to apply to it
+    // Stats endpoint: --telemetry <endpoint>, watch it with telemetry_viewer
+    // Rooms: --threads <n> pool threads, --max-rooms <n>, --port <n> (snapshots on n, commands on n + 1)
+    // Bandwidth: --client-kbps <n> fits each player's snapshots in n kbit/s, most important updates first
+    // Optional session capture: --record <log> and --record-room <id> (default 0), or --replay <log>
+    // hardware_concurrency() is 0 when it can't tell, so test before subtracting
+    const unsigned hc = std::thread::hardware_concurrency();
+    unsigned threadCount = hc > 1 ? hc - 1 : 1;
+    for (int i = 1; i + 1 < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--scene") {
+            scenePath = argv[++i];
+            continue;
+        }
+        if (arg == "--telemetry") {
+            telemetryEndpoint = argv[++i];
+            continue;
+        }
+        if (arg == "--threads") {
+            threadCount = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+            continue;
+        }
+        if (arg == "--max-rooms") {
+            maxRooms = std::max(1, std::atoi(argv[++i]));
+            continue;
+        }
+        if (arg == "--port") {
+            basePort = std::atoi(argv[++i]);
+            continue;
+        }
+        if (arg == "--client-kbps") {
+            clientBudgetKbps = std::max(0.0f, static_cast<float>(std::atof(argv[++i])));
+            continue;
+        }
+        if (arg == "--record-room") {
+            recordRoom = std::atoi(argv[++i]);
+            continue;
+        }
+        if (arg == "--replay") {
+            return runReplay(argv[i + 1]);
+        }
+        if (arg == "--record") {
+            if (sessionRecorder.open(argv[i + 1])) {
+                std::cout << "[Server] Recording room " << recordRoom << " to " << argv[i + 1] << "\n";
+            }
+            ++i;
+        }
+    }
+
+    loadLevelObjects();
+    tickStats.reset(new TickStats(std::chrono::duration_cast<std::chrono::nanoseconds>(TICK_PERIOD).count(),
+        static_cast<size_t>(maxRooms) * 30));
+
+    zmq::context_t context(THREADS);
+
+    // Bound before the pool starts so every worker's connect finds it
+    zmq::socket_t inbound(context, zmq::socket_type::pull);
+    inbound.bind("inproc://snapshots");
+
+    std::thread netThread(networkThread, std::ref(context), std::ref(inbound));
+
+    std::cout << "[Server] Running up to " << maxRooms << " rooms on " << threadCount << " threads\n";
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < threadCount; ++i) {
+        pool.emplace_back(roomWorker, std::ref(context));
+    }
+
+    // Wait for threads to finish
+    netThread.join();
+    scheduler.stop();
+    for (std::thread& t : pool) t.join();
+    sessionRecorder.close();
+
+    return 0;
+}
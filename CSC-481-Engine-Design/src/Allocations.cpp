@@ -0,0 +1,130 @@
+#include <engine/Allocations.h>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Counters are trivially constructed, so operator new can use them during static init
+thread_local AllocTag Allocations::t_tag = AllocTag::General;
+std::atomic<uint64_t> Allocations::s_frameCount[kTags];
+std::atomic<uint64_t> Allocations::s_frameBytes[kTags];
+std::atomic<uint64_t> Allocations::s_totalCount[kTags];
+std::atomic<uint64_t> Allocations::s_totalBytes[kTags];
+AllocStats Allocations::s_lastFrame[kTags];
+uint64_t Allocations::s_frames = 0;
+uint64_t Allocations::s_steadyFrom = 0;
+
+bool Allocations::isTracking() {
+#ifdef ENGINE_TRACK_ALLOCATIONS
+	return true;
+#else
+	return false;
+#endif
+}
+
+void Allocations::record(size_t bytes) {
+	const int tag = static_cast<int>(t_tag);
+	s_frameCount[tag].fetch_add(1, std::memory_order_relaxed);
+	s_frameBytes[tag].fetch_add(bytes, std::memory_order_relaxed);
+	s_totalCount[tag].fetch_add(1, std::memory_order_relaxed);
+	s_totalBytes[tag].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/**
+ * Latches the counts of the frame that just ended and zeroes them for the next one.
+ * Past the steady state point a frame that allocated is reported per tag, and asserts.
+ * Every thread counts toward the frame it allocated in, not only the main thread.
+ */
+void Allocations::nextFrame() {
+	uint64_t allocated = 0;
+	for (int i = 0; i < kTags; ++i) {
+		s_lastFrame[i].count = s_frameCount[i].exchange(0, std::memory_order_relaxed);
+		s_lastFrame[i].bytes = s_frameBytes[i].exchange(0, std::memory_order_relaxed);
+		allocated += s_lastFrame[i].count;
+	}
+	++s_frames;
+
+	if (s_steadyFrom == 0 || s_frames < s_steadyFrom || allocated == 0) return;
+	// printf, not iostream, so the report doesn't allocate into the next frame
+	std::fprintf(stderr, "[Allocations] frame %llu allocated %llu times:",
+		static_cast<unsigned long long>(s_frames), static_cast<unsigned long long>(allocated));
+	for (int i = 0; i < kTags; ++i) {
+		if (s_lastFrame[i].count == 0) continue;
+		std::fprintf(stderr, " %s %llu (%llu bytes)", tagName(static_cast<AllocTag>(i)),
+			static_cast<unsigned long long>(s_lastFrame[i].count), static_cast<unsigned long long>(s_lastFrame[i].bytes));
+	}
+	std::fprintf(stderr, "\n");
+	assert(!"steady state frame allocated");
+}
+
+AllocStats Allocations::lastFrame(AllocTag tag) {
+	return s_lastFrame[static_cast<int>(tag)];
+}
+
+AllocStats Allocations::lastFrameTotal() {
+	AllocStats sum;
+	for (int i = 0; i < kTags; ++i) {
+		sum.count += s_lastFrame[i].count;
+		sum.bytes += s_lastFrame[i].bytes;
+	}
+	return sum;
+}
+
+AllocStats Allocations::total(AllocTag tag) {
+	const int i = static_cast<int>(tag);
+	return { s_totalCount[i].load(std::memory_order_relaxed), s_totalBytes[i].load(std::memory_order_relaxed) };
+}
+
+uint64_t Allocations::frameCount() {
+	return s_frames;
+}
+
+void Allocations::setSteadyStateAfter(uint64_t warmupFrames) {
+	s_steadyFrom = warmupFrames > 0 ? s_frames + warmupFrames : 0;
+}
+
+const char* Allocations::tagName(AllocTag tag) {
+	switch (tag) {
+	case AllocTag::General: return "general";
+	case AllocTag::Engine: return "engine";
+	case AllocTag::Game: return "game";
+	case AllocTag::Render: return "render";
+	case AllocTag::Network: return "network";
+	case AllocTag::Streaming: return "streaming";
+	default: return "unknown";
+	}
+}
+
+AllocTag Allocations::currentTag() {
+	return t_tag;
+}
+
+#ifdef ENGINE_TRACK_ALLOCATIONS
+// Global operator new and delete, so every heap allocation in the program is counted.
+// Aligned (over-aligned type) allocations keep the library's versions and aren't counted.
+void* operator new(std::size_t size) {
+	Allocations::record(size);
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+	Allocations::record(size);
+	return std::malloc(size ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t& tag) noexcept {
+	return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+#endif
@@ -0,0 +1,201 @@
+#include <engine/Assets.h>
+#include <engine/Engine.h>
+#include <SDL3_image/SDL_image.h>
+#include <cstring>
+#include <iostream>
+
+static_assert(sizeof(AssetPackHeader) == 24, "AssetPackHeader is part of the file format");
+static_assert(sizeof(AssetPackEntry) == 104, "AssetPackEntry is part of the file format");
+static_assert(sizeof(AssetGlyph) == 12, "AssetGlyph is part of the file format");
+
+MappedFile Assets::s_pack;
+const AssetPackEntry* Assets::s_entries = nullptr;
+uint32_t Assets::s_entryCount = 0;
+std::unordered_map<std::string, uint32_t> Assets::s_index;
+std::unordered_map<std::string, Assets::CachedTexture> Assets::s_textures;
+std::string Assets::s_textureKey;
+std::unordered_map<SDL_Texture*, std::string> Assets::s_texturePaths;
+std::unordered_map<std::string, AssetFont> Assets::s_fonts;
+std::mutex Assets::s_mutex;
+
+/**
+ * Maps an asset pack and indexes its entries by name.
+ * Entries whose data runs past the end of the file are left out of the index.
+ * @param path The .pack file written by asset_pack.
+ * @return true if the pack was mapped, false otherwise.
+ */
+bool Assets::openPack(const std::string& path) {
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_pack.close();
+	s_index.clear();
+	s_entries = nullptr;
+	s_entryCount = 0;
+
+	if (!s_pack.open(path)) {
+		std::cerr << "Assets: could not map " << path << std::endl;
+		return false;
+	}
+	const uint64_t length = s_pack.size();
+	const AssetPackHeader* header = reinterpret_cast<const AssetPackHeader*>(s_pack.data());
+	if (length < sizeof(AssetPackHeader) || std::memcmp(header->magic, "CSCPACK", 8) != 0 || header->version != kPackVersion ||
+		header->entriesOffset > length || header->entryCount > (length - header->entriesOffset) / sizeof(AssetPackEntry)) {
+		std::cerr << "Assets: " << path << " is not a valid asset pack" << std::endl;
+		s_pack.close();
+		return false;
+	}
+
+	s_entries = reinterpret_cast<const AssetPackEntry*>(s_pack.data() + header->entriesOffset);
+	s_entryCount = header->entryCount;
+	for (uint32_t i = 0; i < s_entryCount; ++i) {
+		const AssetPackEntry& e = s_entries[i];
+		const uint64_t pixels = static_cast<uint64_t>(e.width) * e.height * 4;
+		const uint64_t glyphs = static_cast<uint64_t>(e.glyphCount) * sizeof(AssetGlyph);
+		if (e.name[sizeof(e.name) - 1] != '\0' || e.pixelsOffset > length || pixels > length - e.pixelsOffset ||
+			e.glyphsOffset > length || glyphs > length - e.glyphsOffset) {
+			std::cerr << "Assets: skipping damaged entry " << i << " in " << path << std::endl;
+			continue;
+		}
+		s_index[e.name] = i;
+	}
+	return true;
+}
+
+void Assets::closePack() {
+	std::lock_guard<std::mutex> lock(s_mutex);
+	s_index.clear();
+	s_entries = nullptr;
+	s_entryCount = 0;
+	s_pack.close();
+}
+
+// Entry of the given type by name, null if the pack doesn't have it
+const AssetPackEntry* Assets::findEntry(const std::string& name, uint32_t type) {
+	auto it = s_index.find(name);
+	if (it == s_index.end() || s_entries[it->second].type != type) return nullptr;
+	return &s_entries[it->second];
+}
+
+// Creates a texture and copies the entry's pixels into it straight from the mapping
+SDL_Texture* Assets::upload(SDL_Renderer* renderer, const AssetPackEntry& entry) {
+	SDL_Texture* texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STATIC,
+		static_cast<int>(entry.width), static_cast<int>(entry.height));
+	if (!texture) return nullptr;
+	SDL_UpdateTexture(texture, nullptr, s_pack.data() + entry.pixelsOffset, static_cast<int>(entry.width * 4));
+	SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+	return texture;
+}
+
+/**
+ * Gets the shared texture for an image path.
+ * The pack's pre-decoded copy is used when it has one, otherwise the file is decoded with SDL_image.
+ * @param path The image path, also the pack entry name.
+ * @return The texture, or null if there is no renderer or it can't be loaded.
+ */
+SDL_Texture* Assets::acquireTexture(const char* path) {
+	SDL_Renderer* renderer = Engine::getRenderer();
+	if (!path || !renderer) return nullptr;
+
+	std::lock_guard<std::mutex> lock(s_mutex);
+	// Spawns hit the cache, the key buffer keeps its capacity so they don't allocate
+	s_textureKey.assign(path);
+	auto found = s_textures.find(s_textureKey);
+	if (found != s_textures.end()) {
+		++found->second.refs;
+		return found->second.texture;
+	}
+
+	SDL_Texture* texture = nullptr;
+	if (const AssetPackEntry* entry = findEntry(s_textureKey, AssetPackEntry::Texture)) {
+		texture = upload(renderer, *entry);
+	}
+	else if (SDL_Surface* surface = IMG_Load(path)) {
+		texture = SDL_CreateTextureFromSurface(renderer, surface);
+		SDL_DestroySurface(surface);
+	}
+	else {
+		std::cerr << "Failed to load surface from " << path << ": " << SDL_GetError() << std::endl;
+	}
+	if (!texture) return nullptr;
+
+	s_textures.emplace(s_textureKey, CachedTexture{ texture, 1 });
+	s_texturePaths[texture] = s_textureKey;
+	return texture;
+}
+
+void Assets::releaseTexture(SDL_Texture* texture) {
+	if (!texture) return;
+	std::lock_guard<std::mutex> lock(s_mutex);
+	auto path = s_texturePaths.find(texture);
+	if (path == s_texturePaths.end()) return;
+
+	auto cached = s_textures.find(path->second);
+	if (--cached->second.refs > 0) return;
+	SDL_DestroyTexture(texture);
+	s_textures.erase(cached);
+	s_texturePaths.erase(path);
+}
+
+/**
+ * Gets a font atlas from the pack, uploading it the first time.
+ * @param name The font's entry name in the pack manifest.
+ * @return The font, or null if the pack has no font by that name.
+ */
+const AssetFont* Assets::getFont(const std::string& name) {
+	std::lock_guard<std::mutex> lock(s_mutex);
+	auto it = s_fonts.find(name);
+	if (it != s_fonts.end()) return &it->second;
+
+	SDL_Renderer* renderer = Engine::getRenderer();
+	const AssetPackEntry* entry = findEntry(name, AssetPackEntry::Font);
+	if (!entry || !renderer) return nullptr;
+
+	AssetFont font;
+	font.atlas = upload(renderer, *entry);
+	if (!font.atlas) return nullptr;
+	font.firstGlyph = entry->firstGlyph;
+	font.lineHeight = entry->lineHeight;
+	const AssetGlyph* glyphs = reinterpret_cast<const AssetGlyph*>(s_pack.data() + entry->glyphsOffset);
+	font.glyphs.assign(glyphs, glyphs + entry->glyphCount);
+	return &s_fonts.emplace(name, std::move(font)).first->second;
+}
+
+/**
+ * Draws text one glyph at a time from a font atlas. Characters the atlas lacks are skipped.
+ * @param renderer The renderer to draw with.
+ * @param font The font from getFont.
+ * @param text The text, one byte per character.
+ * @param x Left edge of the text.
+ * @param y Top edge of the text.
+ * @param color Text color.
+ */
+void Assets::drawText(SDL_Renderer* renderer, const AssetFont* font, std::string_view text,
+	float x, float y, SDL_Color color) {
+	if (!renderer || !font || !font->atlas) return;
+
+	SDL_SetTextureColorMod(font->atlas, color.r, color.g, color.b);
+	SDL_SetTextureAlphaMod(font->atlas, color.a);
+	float penX = x;
+	for (unsigned char c : text) {
+		if (c < font->firstGlyph || c - font->firstGlyph >= font->glyphs.size()) continue;
+		const AssetGlyph& g = font->glyphs[c - font->firstGlyph];
+		if (g.w > 0 && g.h > 0) {
+			SDL_FRect src = { static_cast<float>(g.x), static_cast<float>(g.y), static_cast<float>(g.w), static_cast<float>(g.h) };
+			SDL_FRect dst = { penX, y, static_cast<float>(g.w), static_cast<float>(g.h) };
+			SDL_RenderTexture(renderer, font->atlas, &src, &dst);
+		}
+		penX += g.advance;
+	}
+}
+
+void Assets::clear() {
+	std::lock_guard<std::mutex> lock(s_mutex);
+	for (auto& [path, cached] : s_textures) {
+		if (cached.texture) SDL_DestroyTexture(cached.texture);
+	}
+	for (auto& [name, font] : s_fonts) {
+		if (font.atlas) SDL_DestroyTexture(font.atlas);
+	}
+	s_textures.clear();
+	s_texturePaths.clear();
+	s_fonts.clear();
+}
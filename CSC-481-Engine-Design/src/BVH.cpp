@@ -0,0 +1,115 @@
+#include <engine/BVH.h>
+#include <engine/Entity.h>
+#include <algorithm>
+#include <numeric>
+
+/**
+ * Builds the tree top down, splitting each range at the median of its longest axis.
+ * @param entities The entities to store, their rects are read once here.
+ */
+void BVH::build(const std::vector<Entity*>& entities) {
+	clear();
+	items.reserve(entities.size());
+	itemBounds.reserve(entities.size());
+	for (Entity* e : entities) {
+		if (!e) continue;
+		const SDL_FRect r = e->getRect();
+		items.push_back(e);
+		itemBounds.push_back({ r.x, r.y, r.x + r.w, r.y + r.h });
+	}
+	if (items.empty()) return;
+
+	nodes.reserve(2 * (items.size() / kLeafSize + 1));
+	buildRange(0, static_cast<int32_t>(items.size()));
+}
+
+void BVH::clear() {
+	nodes.clear();
+	items.clear();
+	itemBounds.clear();
+}
+
+size_t BVH::size() const {
+	return items.size();
+}
+
+/**
+ * Builds the subtree over items [first, first + count).
+ * @return The index of the subtree's root node.
+ */
+int32_t BVH::buildRange(int32_t first, int32_t count) {
+	// Bounds of the whole range
+	Bounds b = itemBounds[first];
+	for (int32_t i = first + 1; i < first + count; ++i) {
+		b.minX = std::min(b.minX, itemBounds[i].minX);
+		b.minY = std::min(b.minY, itemBounds[i].minY);
+		b.maxX = std::max(b.maxX, itemBounds[i].maxX);
+		b.maxY = std::max(b.maxY, itemBounds[i].maxY);
+	}
+
+	const int32_t index = static_cast<int32_t>(nodes.size());
+	nodes.push_back({ b, -1, -1, first, count });
+	if (count <= kLeafSize) return index;
+
+	// Split at the median center along the longest axis
+	const bool splitX = (b.maxX - b.minX) >= (b.maxY - b.minY);
+	std::vector<int32_t> order(count);
+	std::iota(order.begin(), order.end(), first);
+	const int32_t half = count / 2;
+	std::nth_element(order.begin(), order.begin() + half, order.end(), [&](int32_t a, int32_t c) {
+		const Bounds& ba = itemBounds[a];
+		const Bounds& bc = itemBounds[c];
+		return splitX ? (ba.minX + ba.maxX) < (bc.minX + bc.maxX) : (ba.minY + ba.maxY) < (bc.minY + bc.maxY);
+	});
+
+	// Apply the new order to the range
+	std::vector<Entity*> sortedItems(count);
+	std::vector<Bounds> sortedBounds(count);
+	for (int32_t i = 0; i < count; ++i) {
+		sortedItems[i] = items[order[i]];
+		sortedBounds[i] = itemBounds[order[i]];
+	}
+	std::copy(sortedItems.begin(), sortedItems.end(), items.begin() + first);
+	std::copy(sortedBounds.begin(), sortedBounds.end(), itemBounds.begin() + first);
+
+	const int32_t left = buildRange(first, half);
+	const int32_t right = buildRange(first + half, count - half);
+	nodes[index].left = left;
+	nodes[index].right = right;
+	nodes[index].count = 0;
+	return index;
+}
+
+/**
+ * Finds every stored entity overlapping an area.
+ * Touching edges don't count, matching Collision::checkCollision.
+ * @param area The area to search.
+ * @param out Matching entities are appended here.
+ */
+void BVH::query(const SDL_FRect& area, std::vector<Entity*>& out) const {
+	if (nodes.empty()) return;
+
+	const Bounds q = { area.x, area.y, area.x + area.w, area.y + area.h };
+	auto overlaps = [&q](const Bounds& b) {
+		return q.minX < b.maxX && q.maxX > b.minX && q.minY < b.maxY && q.maxY > b.minY;
+	};
+
+	// Depth is about log2(n / kLeafSize), so a small fixed stack covers any level
+	int32_t stack[64];
+	int32_t top = 0;
+	stack[top++] = 0;
+	while (top > 0) {
+		const Node& node = nodes[stack[--top]];
+		if (!overlaps(node.bounds)) continue;
+
+		if (node.left < 0) {
+			for (int32_t i = node.first; i < node.first + node.count; ++i) {
+				if (overlaps(itemBounds[i])) out.push_back(items[i]);
+			}
+		}
+		else {
+			stack[top++] = node.left;
+			stack[top++] = node.right;
+		}
+	}
+}
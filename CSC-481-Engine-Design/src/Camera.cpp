@@ -0,0 +1,92 @@
+#include <engine/Camera.h>
+#include <algorithm>
+
+void Camera::setViewport(float w, float h) {
+	viewportW = std::max(w, 1.0f);
+	viewportH = std::max(h, 1.0f);
+}
+
+void Camera::setDesignSize(float w, float h) {
+	designW = std::max(w, 1.0f);
+	designH = std::max(h, 1.0f);
+}
+
+void Camera::setCenter(OrderedPair c) {
+	center = c;
+}
+
+OrderedPair Camera::getCenter() const {
+	return center;
+}
+
+void Camera::setZoom(float z) {
+	zoom = std::clamp(z, 0.1f, 10.0f);
+}
+
+float Camera::getZoom() const {
+	return zoom;
+}
+
+void Camera::setBounds(const SDL_FRect& b) {
+	bounds = b;
+	bounded = true;
+}
+
+void Camera::clearBounds() {
+	bounded = false;
+}
+
+/**
+ * Gets the scale from world units to screen pixels.
+ * The design size is fit into the viewport keeping its aspect ratio, then zoom is applied.
+ * @return Screen pixels per world unit.
+ */
+float Camera::getScale() const {
+	return std::min(viewportW / designW, viewportH / designH) * zoom;
+}
+
+/**
+ * Gets the world area on screen around the center.
+ * With bounds set, the view is pushed back inside them on each axis, or centered on
+ * them on an axis where the view is larger than the bounds.
+ * @return The visible world rect.
+ */
+SDL_FRect Camera::getView() const {
+	const float scale = getScale();
+	SDL_FRect view;
+	view.w = viewportW / scale;
+	view.h = viewportH / scale;
+	view.x = center.x - view.w * 0.5f;
+	view.y = center.y - view.h * 0.5f;
+
+	if (bounded) {
+		if (view.w >= bounds.w) view.x = bounds.x + (bounds.w - view.w) * 0.5f;
+		else view.x = std::clamp(view.x, bounds.x, bounds.x + bounds.w - view.w);
+		if (view.h >= bounds.h) view.y = bounds.y + (bounds.h - view.h) * 0.5f;
+		else view.y = std::clamp(view.y, bounds.y, bounds.y + bounds.h - view.h);
+	}
+	return view;
+}
+
+OrderedPair Camera::worldToScreen(OrderedPair p) const {
+	const SDL_FRect view = getView();
+	const float scale = getScale();
+	return { (p.x - view.x) * scale, (p.y - view.y) * scale };
+}
+
+SDL_FRect Camera::worldToScreen(const SDL_FRect& r) const {
+	const SDL_FRect view = getView();
+	const float scale = getScale();
+	return { (r.x - view.x) * scale, (r.y - view.y) * scale, r.w * scale, r.h * scale };
+}
+
+OrderedPair Camera::screenToWorld(OrderedPair p) const {
+	const SDL_FRect view = getView();
+	const float scale = getScale();
+	return { p.x / scale + view.x, p.y / scale + view.y };
+}
+
+bool Camera::isVisible(const SDL_FRect& r) const {
+	const SDL_FRect view = getView();
+	return r.x < view.x + view.w && r.x + r.w > view.x && r.y < view.y + view.h && r.y + r.h > view.y;
+}
@@ -1,104 +1,191 @@
-#include <engine/Client.h>
-#include <sstream>
-#include <iostream>
-
-// static member init
-int Client::clientID = 0;
-
-Client::Client()
-    : context(1),
-    requester(context, zmq::socket_type::req),
-    subscriber(context, zmq::socket_type::sub) {
-}
-
-Client::~Client() {
-    requester.close();
-    subscriber.close();
-    context.close();
-}
-
-void Client::setClientID(int id) {
-	clientID = id;
-}
-
-bool Client::connect(const std::string& serverAddress) {
-	try {
-		requester = zmq::socket_t(context, zmq::socket_type::req);
-		subscriber = zmq::socket_t(context, zmq::socket_type::sub);
-
-		// avoid hard hangs if server hiccups
-		requester.set(zmq::sockopt::rcvtimeo, 1);
-		requester.set(zmq::sockopt::sndtimeo, 1000);
-		requester.set(zmq::sockopt::linger, 0);
-
-		const std::string reqAddr = serverAddress + ":" + std::to_string(5556 + clientID);
-		requester.connect(reqAddr);
-		std::cout << "[Client] Connected REQ to " << reqAddr << "\n";
-
-		subscriber.connect(serverAddress + ":5555");
-		subscriber.set(zmq::sockopt::subscribe, "");
-		std::cout << "[Client] Connected SUB to " << serverAddress << ":5555\n";
-		return true;
-	}
-	catch (const zmq::error_t& e) {
-		std::cerr << "[ZMQ Error] " << e.what() << " (code " << e.num() << ")\n";
-		return false;
-	}
-}
-
-void Client::sendCommand(const ClientCommand& cmd) {
-	// If previous request hasn't been acked, try to pull it now (non-blocking).
-	if (awaitingReply) {
-		zmq::message_t pending;
-		auto got = requester.recv(pending, zmq::recv_flags::dontwait);
-		if (got) {
-			awaitingReply = false; // ack drained, we may send again
-		}
-		else {
-			return; // skip sending this frame; REQ must strictly alternate
-		}
-	}
-
-	std::ostringstream oss;
-	oss << "CMD " << cmd.clientId << " " << cmd.tick << " " << cmd.actions
-		<< " " << cmd.x << " " << cmd.y;
-	std::string msg = oss.str();
-
-	zmq::message_t request(msg.size());
-	memcpy(request.data(), msg.data(), msg.size());
-	requester.send(request, zmq::send_flags::none);
-	awaitingReply = true; // we must receive before next send
-}
-
-bool Client::pollUpdate(WorldSnapshot& out) {
-	zmq::message_t msg;
-	if (!subscriber.recv(msg, zmq::recv_flags::dontwait)) return false;
-
-	std::string data(static_cast<char*>(msg.data()), msg.size());
-	std::istringstream iss(data);
-
-	std::string tag; int tick, playerCount, objectCount;
-	if (!(iss >> tag) || tag != "SNAP") return false;
-	if (!(iss >> tick >> playerCount >> objectCount)) return false;
-
-	out.tick = tick;
-	out.playerIds.resize(playerCount);
-	out.playerPositions.resize(playerCount);
-	out.syncedObjects.resize(objectCount);
-
-	for (int i = 0; i < playerCount; ++i) {
-		int id; float x, y;
-		if (!(iss >> id >> x >> y)) return false;
-		out.playerIds[i] = id;
-		out.playerPositions[i] = { x, y };
-	}
-	
-	// Read synchronized objects (id, type, x, y)
-	for (int j = 0; j < objectCount; ++j) {
-		int id, type; float x, y;
-		if (!(iss >> id >> type >> x >> y)) return false;
-		out.syncedObjects[j] = { id, type, {x, y} };
-	}
-	
-	return true;
-}
\ No newline at end of file
+#include <engine/Client.h>
+#include <engine/Protocol.h>
+#include <engine/Allocations.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+// static member init
+int Client::clientID = 0;
+
+// A reply this late was lost on the way, so REQ is reopened instead of waiting forever
+static const uint64_t REPLY_TIMEOUT_NS = 500000000;
+
+static uint64_t steadyNowNS() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Fresh REQ socket connected to the command port
+static zmq::socket_t openRequester(zmq::context_t& context, const std::string& address) {
+	zmq::socket_t requester(context, zmq::socket_type::req);
+
+	// avoid hard hangs if server hiccups
+	requester.set(zmq::sockopt::rcvtimeo, 1);
+	requester.set(zmq::sockopt::sndtimeo, 1000);
+	requester.set(zmq::sockopt::linger, 0);
+	requester.connect(address);
+	return requester;
+}
+
+Client::Client()
+    : context(1),
+    requester(context, zmq::socket_type::req),
+    subscriber(context, zmq::socket_type::sub) {
+}
+
+Client::~Client() {
+    requester.close();
+    subscriber.close();
+    context.close();
+}
+
+void Client::setClientID(int id) {
+	clientID = id;
+}
+
+bool Client::connect(const std::string& serverAddress, int roomId, int port) {
+	room = roomId;
+	try {
+		// Every client shares the server's command port, the room is in each command
+		commandAddress = serverAddress + ":" + std::to_string(port + 1);
+		requester = openRequester(context, commandAddress);
+		awaitingReply = false;
+		std::cout << "[Client] Connected REQ to " << commandAddress << " for room " << room << "\n";
+
+		const std::string subAddr = serverAddress + ":" + std::to_string(port);
+		subscriber = zmq::socket_t(context, zmq::socket_type::sub);
+		subscriber.connect(subAddr);
+		subscriber.set(zmq::sockopt::subscribe, Protocol::roomTopic(room));
+		subscriber.set(zmq::sockopt::subscribe, Protocol::playerTopic(room, clientID)); // budgeted snapshots
+		std::cout << "[Client] Connected SUB to " << subAddr << "\n";
+		return true;
+	}
+	catch (const zmq::error_t& e) {
+		std::cerr << "[ZMQ Error] " << e.what() << " (code " << e.num() << ")\n";
+		return false;
+	}
+}
+
+/**
+ * Starts recording received snapshots and sent commands.
+ * @param path The session log to append to.
+ * @return true if the log was opened, false otherwise.
+ */
+bool Client::startRecording(const std::string& path) {
+	if (!recorder.open(path)) return false;
+	std::cout << "[Client] Recording session to " << path << "\n";
+	return true;
+}
+
+/**
+ * Switches the client to replay mode. pollUpdate then returns the recorded
+ * snapshots back to back and commands are no longer sent.
+ * @param path The session log to play.
+ * @return true if the log was mapped, false otherwise.
+ */
+bool Client::startReplay(const std::string& path) {
+	if (!replay.open(path)) return false;
+	std::cout << "[Client] Replaying session from " << path << "\n";
+	return true;
+}
+
+bool Client::isReplaying() const {
+	return replay.isOpen();
+}
+
+void Client::sendCommand(const ClientCommand& cmd) {
+	// Nothing is listening while replaying a session
+	if (replay.isOpen()) return;
+	AllocScope scope(AllocTag::Network);
+
+	// If previous request hasn't been acked, try to pull it now (non-blocking).
+	if (awaitingReply) {
+		zmq::message_t pending;
+		auto got = requester.recv(pending, zmq::recv_flags::dontwait);
+		if (got) {
+			awaitingReply = false; // ack drained, we may send again
+		}
+		else if (steadyNowNS() - sentAtNS > REPLY_TIMEOUT_NS) {
+			// The command or its reply was dropped, REQ can only move on with a new socket
+			requester = openRequester(context, commandAddress);
+			awaitingReply = false;
+		}
+		else {
+			return; // skip sending this frame; REQ must strictly alternate
+		}
+	}
+
+	ClientCommand routed = cmd;
+	routed.room = room;
+	Protocol::encodeCommand(routed, sendBuffer);
+
+	zmq::message_t request(sendBuffer.size());
+	memcpy(request.data(), sendBuffer.data(), sendBuffer.size());
+	requester.send(request, zmq::send_flags::none);
+	awaitingReply = true; // we must receive before next send
+	sentAtNS = steadyNowNS();
+	recorder.record(RecordType::Command, cmd.tick, sendBuffer);
+}
+
+bool Client::pollUpdate(WorldSnapshot& out) {
+	AllocScope scope(AllocTag::Network);
+	// Replay mode reads the next recorded snapshot straight from the mapping
+	if (replay.isOpen()) {
+		ReplayRecord record;
+		if (!replay.next(RecordType::Snapshot, record)) return false;
+		return Protocol::decodeSnapshot(record.data, record.size, out);
+	}
+
+	// Room topic frame, then the snapshot itself
+	zmq::message_t topic, msg;
+	if (!subscriber.recv(topic, zmq::recv_flags::dontwait)) return false;
+	if (!topic.more() || !subscriber.recv(msg, zmq::recv_flags::none)) return false;
+
+	const char* data = static_cast<const char*>(msg.data());
+	if (!Protocol::decodeSnapshot(data, msg.size(), out)) return false;
+
+	recorder.record(RecordType::Snapshot, out.tick, data, msg.size());
+	return true;
+}
+
+/**
+ * Blocks until a snapshot arrives or the timeout passes, so the network thread sleeps
+ * in the kernel between snapshots instead of polling.
+ * @param out Receives the snapshot.
+ * @param timeoutMs Longest time to wait, in milliseconds.
+ * @return true if a snapshot was received.
+ */
+bool Client::waitForUpdate(WorldSnapshot& out, int timeoutMs) {
+	using clock = std::chrono::steady_clock;
+	AllocScope scope(AllocTag::Network);
+
+	if (replay.isOpen()) {
+		ReplayRecord record;
+		if (!replay.next(RecordType::Snapshot, record)) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(timeoutMs)); // log finished
+			return false;
+		}
+
+		// Hand each snapshot out at its recorded offset so playback runs at capture speed
+		const uint64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now().time_since_epoch()).count();
+		if (replayStartNS == 0) {
+			replayStartNS = now;
+			replayBaseNS = record.timeNS;
+		}
+		const uint64_t due = replayStartNS + (record.timeNS - replayBaseNS);
+		if (due > now) std::this_thread::sleep_for(std::chrono::nanoseconds(due - now));
+		return Protocol::decodeSnapshot(record.data, record.size, out);
+	}
+
+	zmq::pollitem_t items[] = { { subscriber.handle(), 0, ZMQ_POLLIN, 0 } };
+	try {
+		if (zmq::poll(items, 1, std::chrono::milliseconds(timeoutMs)) <= 0) return false;
+	}
+	catch (const zmq::error_t& e) {
+		std::cerr << "[ZMQ Error] " << e.what() << " (code " << e.num() << ")\n";
+		return false;
+	}
+	return pollUpdate(out);
+}
@@ -1,21 +1,178 @@
-#include <engine/Collision.h>
-
-/**
- * Checks for a collision between two entities using detection.
- * This is a simple and fast method that checks for an overlap between the two entities' rectangular
- * bounding boxes on both the X and Y axes.
- * @param a The first entity.
- * @param b The second entity.
- * @return true if the two entities are overlapping, false otherwise.
- */
-bool Collision::checkCollision(const Entity& a, const Entity& b) {
-    // Get the bounding rectangles for both entities.
-    SDL_FRect rectA = a.getRect();
-    SDL_FRect rectB = b.getRect();
-    // Check if there is an overlap on the X axis.
-    bool xOverlap = (rectA.x < rectB.x + rectB.w) && (rectA.x + rectA.w > rectB.x);
-    // Check if there is an overlap on the Y axis.
-    bool yOverlap = (rectA.y < rectB.y + rectB.h) && (rectA.y + rectA.h > rectB.y);
-    // Return true only if there is an overlap on both axes.
-    return xOverlap && yOverlap;
-}
+#include <engine/Collision.h>
+#include <algorithm>
+#include <limits>
+
+/**
+ * Checks for a collision between two entities using detection.
+ * This is a simple and fast method that checks for an overlap between the two entities' rectangular
+ * bounding boxes on both the X and Y axes.
+ * @param a The first entity.
+ * @param b The second entity.
+ * @return true if the two entities are overlapping, false otherwise.
+ */
+bool Collision::checkCollision(const Entity& a, const Entity& b) {
+    // Get the bounding rectangles for both entities.
+    SDL_FRect rectA = a.getRect();
+    SDL_FRect rectB = b.getRect();
+    // Check if there is an overlap on the X axis.
+    bool xOverlap = (rectA.x < rectB.x + rectB.w) && (rectA.x + rectA.w > rectB.x);
+    // Check if there is an overlap on the Y axis.
+    bool yOverlap = (rectA.y < rectB.y + rectB.h) && (rectA.y + rectA.h > rectB.y);
+    // Return true only if there is an overlap on both axes.
+    return xOverlap && yOverlap;
+}
+
+// Overlap test for two rects, touching edges don't count
+bool Collision::checkCollision(const SDL_FRect& a, const SDL_FRect& b) {
+    return a.x < b.x + b.w && a.x + a.w > b.x && a.y < b.y + b.h && a.y + a.h > b.y;
+}
+
+/**
+ * Finds the time of impact of a moving box against a still box.
+ * Each axis gives the interval of the move during which the boxes overlap on that axis,
+ * and the boxes touch where the two intervals first intersect.
+ * @param moving The moving box at the start of the move.
+ * @param displacement How far the box moves this step.
+ * @param target The box to test against.
+ * @param outHit Receives the contact time and surface normal.
+ * @return true if the boxes first touch during this move, false otherwise.
+ */
+bool Collision::sweep(const SDL_FRect& moving, OrderedPair displacement, const SDL_FRect& target, SweepHit& outHit) {
+    const float inf = std::numeric_limits<float>::infinity();
+
+    // Interval of overlap on the X axis
+    float xEntry, xExit;
+    if (displacement.x > 0.0f) {
+        xEntry = (target.x - (moving.x + moving.w)) / displacement.x;
+        xExit = ((target.x + target.w) - moving.x) / displacement.x;
+    }
+    else if (displacement.x < 0.0f) {
+        xEntry = ((target.x + target.w) - moving.x) / displacement.x;
+        xExit = (target.x - (moving.x + moving.w)) / displacement.x;
+    }
+    else {
+        // Not moving on X, so it has to already overlap on X
+        if (moving.x >= target.x + target.w || moving.x + moving.w <= target.x) return false;
+        xEntry = -inf;
+        xExit = inf;
+    }
+
+    // Interval of overlap on the Y axis
+    float yEntry, yExit;
+    if (displacement.y > 0.0f) {
+        yEntry = (target.y - (moving.y + moving.h)) / displacement.y;
+        yExit = ((target.y + target.h) - moving.y) / displacement.y;
+    }
+    else if (displacement.y < 0.0f) {
+        yEntry = ((target.y + target.h) - moving.y) / displacement.y;
+        yExit = (target.y - (moving.y + moving.h)) / displacement.y;
+    }
+    else {
+        if (moving.y >= target.y + target.h || moving.y + moving.h <= target.y) return false;
+        yEntry = -inf;
+        yExit = inf;
+    }
+
+    const float entry = std::max(xEntry, yEntry);
+    const float exit = std::min(xExit, yExit);
+
+    // No shared interval, contact after this move, or already overlapping at the start
+    if (entry >= exit || entry > 1.0f || entry < 0.0f) return false;
+
+    outHit.time = entry;
+    if (xEntry > yEntry) {
+        outHit.normal = { displacement.x > 0.0f ? -1.0f : 1.0f, 0.0f };
+    }
+    else {
+        outHit.normal = { 0.0f, displacement.y > 0.0f ? -1.0f : 1.0f };
+    }
+    return true;
+}
+
+bool Collision::sweep(const Entity& moving, OrderedPair displacement, const Entity& target, SweepHit& outHit) {
+    if (!sweep(moving.getRect(), displacement, target.getRect(), outHit)) return false;
+    outHit.other = const_cast<Entity*>(&target);
+    return true;
+}
+
+/**
+ * Moves an entity and resolves the move at the earliest contact.
+ * The entity stops on the first surface it reaches, loses its velocity into that surface,
+ * and the rest of the move slides along it, so fast movers can't tunnel through thin obstacles.
+ * @param entity The entity to move.
+ * @param displacement The full move for this step.
+ * @param obstacles Entities to collide with, the entity itself and non-collidable ones are skipped.
+ * @param outHits Receives each contact in order, may be null if maxHits is 0.
+ * @param maxHits Capacity of outHits, also the most surfaces resolved in one move.
+ * @return The number of contacts written to outHits.
+ */
+int Collision::moveAndCollide(Entity& entity, OrderedPair displacement, const std::vector<Entity*>& obstacles,
+                              SweepHit* outHits, int maxHits) {
+    static const std::vector<SDL_FRect> noSolids;
+    return moveAndCollide(entity, displacement, obstacles, noSolids, outHits, maxHits);
+}
+
+/**
+ * Moves an entity against both entity obstacles and static solid rects.
+ * @param solids World space rects to stop at, hits on them have a null other.
+ * @see moveAndCollide(Entity&, OrderedPair, const std::vector<Entity*>&, SweepHit*, int)
+ */
+int Collision::moveAndCollide(Entity& entity, OrderedPair displacement, const std::vector<Entity*>& obstacles,
+                              const std::vector<SDL_FRect>& solids, SweepHit* outHits, int maxHits) {
+    // Always resolve at least a couple of surfaces (e.g. floor then wall) even if the caller keeps none
+    const int passes = std::max(maxHits, 2);
+    int hitCount = 0;
+
+    for (int pass = 0; pass < passes; ++pass) {
+        if (displacement.x == 0.0f && displacement.y == 0.0f) break;
+
+        // Earliest contact among all obstacles
+        SweepHit earliest;
+        bool found = false;
+        for (Entity* other : obstacles) {
+            if (!other || other == &entity || !other->isCollidable()) continue;
+            SweepHit hit;
+            if (sweep(entity, displacement, *other, hit) && (!found || hit.time < earliest.time)) {
+                earliest = hit;
+                found = true;
+            }
+        }
+        const SDL_FRect rect = entity.getRect();
+        for (const SDL_FRect& solid : solids) {
+            SweepHit hit;
+            if (sweep(rect, displacement, solid, hit) && (!found || hit.time < earliest.time)) {
+                earliest = hit;
+                earliest.other = nullptr;
+                found = true;
+            }
+        }
+
+        OrderedPair pos = entity.getPosition();
+        if (!found) {
+            pos.x += displacement.x;
+            pos.y += displacement.y;
+            entity.setPosition(pos);
+            break;
+        }
+
+        // Move up to the contact
+        pos.x += displacement.x * earliest.time;
+        pos.y += displacement.y * earliest.time;
+        entity.setPosition(pos);
+
+        // Drop the velocity going into the surface
+        OrderedPair vel = entity.getVelocityComponents();
+        if (earliest.normal.x != 0.0f && vel.x * earliest.normal.x < 0.0f) vel.x = 0.0f;
+        if (earliest.normal.y != 0.0f && vel.y * earliest.normal.y < 0.0f) vel.y = 0.0f;
+        entity.setVelocityComponents(vel);
+
+        if (hitCount < maxHits && outHits) outHits[hitCount++] = earliest;
+
+        // Slide along the surface for the rest of the move
+        const float remaining = 1.0f - earliest.time;
+        displacement.x = earliest.normal.x != 0.0f ? 0.0f : displacement.x * remaining;
+        displacement.y = earliest.normal.y != 0.0f ? 0.0f : displacement.y * remaining;
+    }
+
+    return hitCount;
+}
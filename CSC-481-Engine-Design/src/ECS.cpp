@@ -0,0 +1,260 @@
+#include <engine/ECS.h>
+#include <engine/Entity.h>
+#include <engine/Physics.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <new>
+
+namespace ecs {
+
+	namespace {
+		// Registered component types, indexed by component id
+		ComponentInfo s_components[kMaxComponents];
+		uint32_t s_componentCount = 0;
+		std::mutex s_registryMutex;
+
+		// Chunks are cache line aligned so component arrays can be loaded with vector instructions
+		constexpr size_t kChunkAlign = 64;
+
+		size_t alignUp(size_t value, size_t align) {
+			return (value + align - 1) & ~(align - 1);
+		}
+	}
+
+	/**
+	 * Records a new component type.
+	 * @return The id used for the type's bit in archetype masks.
+	 */
+	uint32_t registerComponent(size_t size, size_t align, bool tag) {
+		std::lock_guard<std::mutex> lock(s_registryMutex);
+		// Masks hold one bit per type, so a type past the limit has nowhere to go in any build
+		if (s_componentCount >= kMaxComponents) {
+			std::cerr << "ECS: more than " << kMaxComponents << " component types registered" << std::endl;
+			std::abort();
+		}
+		s_components[s_componentCount] = { size, align, tag };
+		return s_componentCount++;
+	}
+
+	const ComponentInfo& componentInfo(uint32_t id) {
+		return s_components[id];
+	}
+
+	World::~World() {
+		for (Archetype& a : archetypes) {
+			for (Chunk& chunk : a.chunks) {
+				::operator delete(chunk.data, std::align_val_t(kChunkAlign));
+			}
+		}
+	}
+
+	/**
+	 * Reuses a freed record or makes a new one.
+	 * @return A handle with the record's current generation.
+	 */
+	EntityId World::allocateId() {
+		uint32_t index;
+		if (!freeRecords.empty()) {
+			index = freeRecords.back();
+			freeRecords.pop_back();
+		}
+		else {
+			index = static_cast<uint32_t>(records.size());
+			records.emplace_back();
+		}
+		records[index].alive = true;
+		++liveCount;
+		return { index, records[index].generation };
+	}
+
+	/**
+	 * Finds the archetype for a component mask, creating it and its chunk layout if needed.
+	 * A chunk holds the entity index column followed by one array per stored component.
+	 * @return The archetype index.
+	 */
+	uint32_t World::archetypeFor(uint64_t mask) {
+		auto found = archetypeByMask.find(mask);
+		if (found != archetypeByMask.end()) return found->second;
+
+		Archetype a;
+		a.mask = mask;
+		std::fill(std::begin(a.offsets), std::end(a.offsets), 0u);
+
+		size_t rowBytes = sizeof(uint32_t);
+		for (uint32_t id = 0; id < kMaxComponents; ++id) {
+			if (!(mask & (uint64_t{ 1 } << id)) || componentInfo(id).tag) continue;
+			a.components.push_back(id);
+			rowBytes += componentInfo(id).size;
+		}
+
+		// Fit as many rows as possible, then shrink until the aligned arrays fit the chunk
+		uint32_t capacity = static_cast<uint32_t>(std::max<size_t>(1, kChunkBytes / rowBytes));
+		size_t end = 0;
+		for (;;) {
+			end = sizeof(uint32_t) * capacity;
+			for (uint32_t id : a.components) {
+				const ComponentInfo& info = componentInfo(id);
+				end = alignUp(end, info.align);
+				a.offsets[id] = static_cast<uint32_t>(end);
+				end += info.size * capacity;
+			}
+			if (end <= kChunkBytes || capacity == 1) break;
+			--capacity;
+		}
+		a.capacity = capacity;
+		a.chunkBytes = static_cast<uint32_t>(alignUp(std::max(end, size_t{ 1 }), kChunkAlign));
+
+		const uint32_t index = static_cast<uint32_t>(archetypes.size());
+		archetypes.push_back(std::move(a));
+		archetypeByMask[mask] = index;
+		return index;
+	}
+
+	/**
+	 * Adds a row at the end of an archetype, allocating a chunk when the last one is full.
+	 * @return The new row.
+	 */
+	uint32_t World::appendRow(uint32_t archetype, uint32_t entityIndex) {
+		Archetype& a = archetypes[archetype];
+		const uint32_t row = a.size;
+		const uint32_t chunkIndex = row / a.capacity;
+		if (chunkIndex == a.chunks.size()) {
+			Chunk chunk;
+			chunk.data = static_cast<unsigned char*>(::operator new(a.chunkBytes, std::align_val_t(kChunkAlign)));
+			a.chunks.push_back(chunk);
+		}
+
+		Chunk& chunk = a.chunks[chunkIndex];
+		reinterpret_cast<uint32_t*>(chunk.data)[chunk.count] = entityIndex;
+		++chunk.count;
+		++a.size;
+
+		records[entityIndex].archetype = archetype;
+		records[entityIndex].row = row;
+		return row;
+	}
+
+	/**
+	 * Removes a row by moving the archetype's last row into its place, keeping chunks packed.
+	 * Empty chunks stay allocated for the next rows added.
+	 */
+	void World::removeRow(uint32_t archetype, uint32_t row) {
+		Archetype& a = archetypes[archetype];
+		const uint32_t last = a.size - 1;
+		Chunk& lastChunk = a.chunks[last / a.capacity];
+		const uint32_t lastSlot = last % a.capacity;
+
+		if (row != last) {
+			Chunk& chunk = a.chunks[row / a.capacity];
+			const uint32_t slot = row % a.capacity;
+			for (uint32_t id : a.components) {
+				const size_t size = componentInfo(id).size;
+				std::memcpy(chunk.data + a.offsets[id] + slot * size,
+					lastChunk.data + a.offsets[id] + lastSlot * size, size);
+			}
+			const uint32_t movedIndex = reinterpret_cast<uint32_t*>(lastChunk.data)[lastSlot];
+			reinterpret_cast<uint32_t*>(chunk.data)[slot] = movedIndex;
+			records[movedIndex].row = row;
+		}
+
+		--lastChunk.count;
+		--a.size;
+	}
+
+	/**
+	 * Moves an entity to the archetype for a new mask, carrying over the components both share.
+	 */
+	void World::moveToArchetype(EntityId id, uint64_t mask) {
+		const uint32_t srcArch = records[id.index].archetype;
+		const uint32_t srcRow = records[id.index].row;
+
+		// Looking up the destination may grow the archetype list, so hold indices, not references
+		const uint32_t dstArch = archetypeFor(mask);
+		const uint32_t dstRow = appendRow(dstArch, id.index);
+
+		Archetype& src = archetypes[srcArch];
+		Archetype& dst = archetypes[dstArch];
+		for (uint32_t cid : dst.components) {
+			if (src.mask & (uint64_t{ 1 } << cid)) {
+				std::memcpy(column(dst, cid, dstRow), column(src, cid, srcRow), componentInfo(cid).size);
+			}
+		}
+
+		removeRow(srcArch, srcRow);
+	}
+
+	void* World::column(Archetype& a, uint32_t cid, uint32_t row) {
+		Chunk& chunk = a.chunks[row / a.capacity];
+		return chunk.data + a.offsets[cid] + (row % a.capacity) * componentInfo(cid).size;
+	}
+
+	// Destroys an entity and bumps its generation so old handles stop resolving
+	void World::destroy(EntityId id) {
+		if (!isAlive(id)) return;
+		Record& rec = records[id.index];
+		removeRow(rec.archetype, rec.row);
+		rec.alive = false;
+		++rec.generation;
+		freeRecords.push_back(id.index);
+		--liveCount;
+	}
+
+	bool World::isAlive(EntityId id) const {
+		return id.index < records.size() && records[id.index].alive && records[id.index].generation == id.generation;
+	}
+
+	size_t World::size() const {
+		return liveCount;
+	}
+
+	namespace systems {
+		/**
+		 * Integrates positions and velocities chunk by chunk with the bulk Physics kernel.
+		 * @param world The world to update.
+		 * @param deltaTime The time step.
+		 */
+		void integrate(World& world, float deltaTime) {
+			const OrderedPair gravity = Physics::getGravityAcceleration();
+			world.eachChunk<Position, Velocity, Gravity>([&](size_t count, Position* p, Velocity* v, Gravity*) {
+				Physics::integrate(&p->value, &v->value, count, gravity, deltaTime);
+			});
+			world.eachChunk<Position, Velocity>([&](size_t count, Position* p, Velocity* v) {
+				Physics::integrate(&p->value, &v->value, count, OrderedPair{}, deltaTime);
+			}, maskOf<Gravity>());
+		}
+
+		// Reads linked Entity objects into their components
+		void pullLegacy(World& world) {
+			world.each<LegacyLink, Position, Velocity>([](LegacyLink& link, Position& p, Velocity& v) {
+				p.value = link.entity->getPosition();
+				v.value = link.entity->getVelocityComponents();
+			});
+		}
+
+		// Writes components back into linked Entity objects
+		void pushLegacy(World& world) {
+			world.each<LegacyLink, Position, Velocity>([](LegacyLink& link, Position& p, Velocity& v) {
+				link.entity->setPosition(p.value);
+				link.entity->setVelocityComponents(v.value);
+			});
+		}
+	}
+
+	/**
+	 * Mirrors an Entity object in the world with Position, Velocity, Size and a LegacyLink
+	 * (plus the Gravity tag if it falls). Systems can then take over its behavior while
+	 * rendering and gameplay code keep using the Entity.
+	 * @param world The world to add to.
+	 * @param entity The entity to mirror, it must outlive the ECS entity.
+	 * @return The new ECS entity.
+	 */
+	EntityId adopt(World& world, Entity* entity) {
+		const SDL_FRect rect = entity->getRect();
+		const EntityId id = world.create(Position{ entity->getPosition() }, Velocity{ entity->getVelocityComponents() },
+			Size{ { rect.w, rect.h } }, LegacyLink{ entity });
+		if (entity->isAffectedByGravity()) world.add(id, Gravity{});
+		return id;
+	}
+}
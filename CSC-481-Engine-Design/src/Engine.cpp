@@ -1,177 +1,710 @@
-#include <engine/Engine.h>
-#include <engine/Input.h>
-#include <engine/Physics.h>
-#include <engine/Collision.h>
-#include <engine/Entity.h>
-#include <SDL3/SDL.h>
-#include <iostream>
-
-// Static members initialization, and core components for the engine working
-SDL_Window* Engine::s_window = nullptr;
-SDL_Renderer* Engine::s_renderer = nullptr;
-bool Engine::s_running = false;
-std::vector<Entity*> Engine::s_entities;
-
-// Static thread member initialization
-std::thread Engine::s_updateThread;
-std::mutex  Engine::s_entitiesMutex;
-std::atomic<bool> Engine::s_workerRunning = false;
-
-/**
- * Initializes the SDL and events, and creates the game window and renderer.
- * @param cfg The configuration struct containing window title, width, and height.
- * @return true if initialization is successful, false otherwise.
- */
-bool Engine::init(const Config& cfg) {
-	if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS) < 0) {
-		SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
-		return false;
-	}
-    // Create the game window.
-	s_window = SDL_CreateWindow(cfg.title, cfg.width, cfg.height, SDL_WINDOW_RESIZABLE);
-	if (!s_window) {
-		SDL_Log("Couldn't create window: %s", SDL_GetError());
-		return false;
-	}
-    // Create the renderer for drawing.
-	s_renderer = SDL_CreateRenderer(s_window, nullptr);
-	if (!s_renderer) {
-		SDL_Log("Couldn't create renderer: %s", SDL_GetError());
-		return false;
-	}
-	return true;
-}
-
-/**
- * Cleans up all resources used by the engine.
- * This includes deleting all entities, destroying the renderer and the window.
- */
-void Engine::shutdown() {
-
-	// stop worker first (if runThreaded was used)
-	s_workerRunning = false;
-	if (s_updateThread.joinable()) s_updateThread.join();
-
-	{	// Clean up all allocated entity objects
-		std::lock_guard<std::mutex> lock(s_entitiesMutex); // lock while destroying entities
-		for (Entity* entity : s_entities) {
-			delete entity;
-		}
-		s_entities.clear();
-	}
-	SDL_DestroyRenderer(s_renderer);
-	SDL_DestroyWindow(s_window);
-	SDL_Quit();
-}
-
-/**
- * Adds a new entity to the engine's list of managed entities.
- * @param entity A pointer to the entity to add.
- */
-void Engine::addEntity(Entity* entity) {
-	std::lock_guard<std::mutex> lock(s_entitiesMutex); // lock for adding entities
-	s_entities.push_back(entity);
-}
-
-/**
- * The main game loop. It handles events, updates game state, and renders the scene.
- * @param update The function to call for game state updates.
- * @param render The function to call for custom render logic.
- */
-void Engine::run(std::function<void(float)> update, std::function<void(void)> render) {
-	
-	s_running = true;
-	s_workerRunning = true; 
-
-	// Worker thread: updates all entities with its own dt
-	s_updateThread = std::thread([&]() {
-		Uint64 last = SDL_GetTicks();
-		while (s_workerRunning) {
-			Uint64 now = SDL_GetTicks();
-			float dt = (now - last) / 1000.0f;
-			last = now;
-
-			// Take a snapshot under lock, then release the lock before calling update()
-			std::vector<Entity*> snapshot;
-			{
-				std::lock_guard<std::mutex> lock(s_entitiesMutex);
-				snapshot = s_entities;
-			}
-
-			for (Entity* e : snapshot) {
-				if (e) e->update(dt);
-			}
-
-			// Sleep for 1 ms
-			SDL_Delay(1);
-		}
-		});
-
-	// Main thread: events, input, game update (network/timeline), render
-	SDL_Event e;
-	Uint64 lastTime = SDL_GetTicks();// Get initial time for delta time calculation
-	while (s_running) {
-        // Process all pending SDL events
-		while (SDL_PollEvent(&e)) {
-			if (e.type == SDL_EVENT_QUIT) {
-				s_running = false;
-			} 
-		}
-        Input::updateKeyboardState();
-
-        // Calculate delta time
-		Uint64 currentTime = SDL_GetTicks();
-		float deltaTime = (currentTime - lastTime) / 1000.0f;
-		lastTime = currentTime;
-
-		update(deltaTime);
-
-		SDL_SetRenderDrawColor(s_renderer, 255, 255, 255, 255);  // white background
-		SDL_RenderClear(s_renderer);
-		
-		// Draw from a snapshot (do not hold the lock during draw())
-		std::vector<Entity*> drawSnapshot;
-		{
-			std::lock_guard<std::mutex> lock(s_entitiesMutex); // lock while drawing
-			drawSnapshot = s_entities;
-		}
-		for (Entity* entity : drawSnapshot) {
-			if (entity) entity->draw();
-		}
-
-		render(); // font does work with it here
-		SDL_RenderPresent(s_renderer);
-	}
-
-	// Shutdown worker
-	s_workerRunning = false;
-	if (s_updateThread.joinable()) s_updateThread.join();
-}
-
-/**
- * Provides access to the global SDL renderer instance.
- * @return A pointer to the SDL_Renderer.
- */
-SDL_Renderer* Engine::getRenderer() {
-	return s_renderer;
-}
-
-// Gets the entity mutex
-std::mutex& Engine::getEntitiesMutex() { 
-	return s_entitiesMutex; 
-}
-
-// Deadlock safe get entities
-std::vector<Entity*> Engine::getEntitiesSnapshot() {
-	std::lock_guard<std::mutex> lock(s_entitiesMutex);
-	return s_entities; // copy
-}
-
-/**
- * Provides access to the list of entities managed by the engine.
- * @return A constant reference to the vector of entity pointers.
- */
- //const std::vector<Entity*>& Engine::getEntities() {
-	 //std::lock_guard<std::mutex> lock(s_entitiesMutex); // lock for getting entities
-	 //return s_entities;
- //}
+#include <engine/Engine.h>
+#include <engine/Assets.h>
+#include <engine/Input.h>
+#include <engine/Physics.h>
+#include <engine/Collision.h>
+#include <engine/Entity.h>
+#include <SDL3/SDL.h>
+#include <algorithm>
+#include <iostream>
+
+// Static members initialization, and core components for the engine working
+SDL_Window* Engine::s_window = nullptr;
+SDL_Renderer* Engine::s_renderer = nullptr;
+std::atomic<bool> Engine::s_running = false;
+bool Engine::s_headless = false;
+std::atomic<Timeline*> Engine::s_timeline{ nullptr };
+std::atomic<Tilemap*> Engine::s_tilemap{ nullptr };
+Camera Engine::s_camera;
+
+// Pacing
+FramePacer Engine::s_framePacer;
+int Engine::s_updateRate = 120;
+std::mutex Engine::s_parkMutex;
+std::condition_variable Engine::s_parkCV;
+std::atomic<uint32_t> Engine::s_actionsHeld{ 0 };
+std::atomic<uint32_t> Engine::s_actionsPressed{ 0 };
+std::atomic<uint32_t> Engine::s_actionsReleased{ 0 };
+std::vector<Entity*> Engine::s_entities;
+std::vector<std::vector<Entity*>> Engine::s_typeLists;
+
+// ECS world and systems
+ecs::World Engine::s_world;
+std::mutex Engine::s_worldMutex;
+std::vector<ecs::EntityId> Engine::s_linkScratch;
+std::vector<std::function<void(ecs::World&, float)>> Engine::s_systems;
+
+// Static partition
+std::vector<Entity*> Engine::s_staticEntities;
+BVH Engine::s_staticTree;
+std::shared_mutex Engine::s_staticMutex;
+std::atomic<bool> Engine::s_staticDirty = false;
+
+// Render handoff
+RenderQueue Engine::s_renderQueue;
+uint64_t Engine::s_removalStamp = 0;
+std::vector<std::pair<uint64_t, const Entity*>> Engine::s_removedLog;
+
+// Static thread member initialization
+std::thread Engine::s_updateThread;
+std::mutex  Engine::s_entitiesMutex;
+std::atomic<bool> Engine::s_workerRunning = false;
+
+/**
+ * Initializes the SDL and events, and creates the game window and renderer.
+ * In headless mode only the event subsystem is started and no window or renderer is made.
+ * @param cfg The configuration struct containing window title, width, height and headless flag.
+ * @return true if initialization is successful, false otherwise.
+ */
+bool Engine::init(const Config& cfg) {
+	s_headless = cfg.headless;
+	s_updateRate = cfg.updateRate;
+	s_camera.setDesignSize(cfg.viewWidth, cfg.viewHeight);
+	s_camera.setViewport(static_cast<float>(cfg.width), static_cast<float>(cfg.height));
+	s_camera.setCenter({ cfg.viewWidth * 0.5f, cfg.viewHeight * 0.5f });
+	s_framePacer.setVsync(0.0);
+	if (s_headless) {
+		if (!SDL_Init(SDL_INIT_EVENTS)) {
+			SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
+			return false;
+		}
+		// No display to block on, so always pace
+		s_framePacer.setTargetRate(cfg.targetFPS > 0 ? cfg.targetFPS : 60);
+		return true;
+	}
+
+	if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS)) {
+		SDL_Log("Couldn't initialize SDL: %s", SDL_GetError());
+		return false;
+	}
+    // Create the game window.
+	s_window = SDL_CreateWindow(cfg.title, cfg.width, cfg.height, SDL_WINDOW_RESIZABLE);
+	if (!s_window) {
+		SDL_Log("Couldn't create window: %s", SDL_GetError());
+		return false;
+	}
+    // Create the renderer for drawing.
+	s_renderer = SDL_CreateRenderer(s_window, nullptr);
+	if (!s_renderer) {
+		SDL_Log("Couldn't create renderer: %s", SDL_GetError());
+		return false;
+	}
+
+	// Let present block to the display when asked, and tell the pacer so it doesn't wait twice
+	const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(s_window));
+	const double refreshRate = mode && mode->refresh_rate > 0.0f ? mode->refresh_rate : 60.0;
+	s_framePacer.setTargetRate(cfg.targetFPS);
+	if (cfg.vsync) {
+		if (SDL_SetRenderVSync(s_renderer, 1)) {
+			s_framePacer.setVsync(refreshRate);
+		}
+		else if (cfg.targetFPS <= 0) {
+			// Nothing blocks the present, so pace to the display instead of spinning
+			SDL_Log("VSync unavailable (%s), pacing to %g Hz", SDL_GetError(), refreshRate);
+			s_framePacer.setTargetRate(refreshRate);
+		}
+	}
+	return true;
+}
+
+/**
+ * Cleans up all resources used by the engine.
+ * This includes deleting all entities, destroying the renderer and the window.
+ */
+void Engine::shutdown() {
+
+	// stop worker first (if runThreaded was used)
+	s_workerRunning = false;
+	wakeWorker();
+	if (s_updateThread.joinable()) s_updateThread.join();
+
+	// No readers are left, so removed entities can go right away
+	Epoch::drain();
+	s_timeline = nullptr; // it belongs to the game
+	if (Tilemap* tilemap = s_tilemap.exchange(nullptr)) {
+		tilemap->close(); // chunk textures have to go before the renderer
+	}
+	s_renderQueue.clear(); // its texture pointers die with the entities
+
+	{	// Clean up all allocated entity objects
+		std::lock_guard<std::mutex> lock(s_entitiesMutex); // lock while destroying entities
+		for (Entity* entity : s_entities) {
+			PoolBase::free(entity); // pooled entities go back to their pool
+		}
+		s_entities.clear();
+		s_typeLists.clear();
+		s_removedLog.clear();
+	}
+	{	// Systems may hold state tied to the game, drop them with the entities
+		std::lock_guard<std::mutex> lock(s_worldMutex);
+		s_systems.clear();
+	}
+	{	// Static bodies are owned by the engine too
+		std::unique_lock<std::shared_mutex> lock(s_staticMutex);
+		s_staticTree.clear();
+		for (Entity* entity : s_staticEntities) {
+			PoolBase::free(entity);
+		}
+		s_staticEntities.clear();
+		s_staticDirty = false;
+	}
+	// Textures left in the asset cache (font atlases, leaked entities) go with the renderer
+	Assets::clear();
+	Assets::closePack();
+	if (s_renderer) SDL_DestroyRenderer(s_renderer);
+	if (s_window) SDL_DestroyWindow(s_window);
+	s_renderer = nullptr;
+	s_window = nullptr;
+	SDL_Quit();
+}
+
+/**
+ * Adds a new entity to the engine's list of managed entities.
+ * @param entity A pointer to the entity to add.
+ */
+void Engine::addEntity(Entity* entity) {
+	{
+		std::lock_guard<std::mutex> lock(s_entitiesMutex); // lock for adding entities
+		s_entities.push_back(entity);
+	}
+	wakeWorker();
+}
+
+/**
+ * Adds an entity and records it in its type's index list.
+ * @param entity A pointer to the entity to add.
+ * @param type The index from typeIndex<T>().
+ */
+void Engine::addEntity(Entity* entity, size_t type) {
+	{
+		std::lock_guard<std::mutex> lock(s_entitiesMutex);
+		s_entities.push_back(entity);
+		indexEntity(entity, type);
+	}
+	wakeWorker();
+}
+
+// Adds a static body and records it in its type's index list
+void Engine::addStaticEntity(Entity* entity, size_t type) {
+	addStaticEntity(entity);
+	std::lock_guard<std::mutex> lock(s_entitiesMutex);
+	indexEntity(entity, type);
+}
+
+// Appends to a type list, caller holds s_entitiesMutex
+void Engine::indexEntity(Entity* entity, size_t type) {
+	if (s_typeLists.size() <= type) s_typeLists.resize(type + 1);
+	s_typeLists[type].push_back(entity);
+}
+
+/**
+ * Grows the entity list and a type list so the next count adds don't reallocate, and the
+ * removal lists so removing them all again doesn't either.
+ * @param count How many more entities to make room for.
+ * @param type The index from typeIndex<T>().
+ */
+void Engine::reserveEntities(size_t count, size_t type) {
+	{
+		std::lock_guard<std::mutex> lock(s_entitiesMutex);
+		s_entities.reserve(s_entities.size() + count);
+		if (s_typeLists.size() <= type) s_typeLists.resize(type + 1);
+		s_typeLists[type].reserve(s_typeLists[type].size() + count);
+		// Every reserved entity could be removed before the next frame is drawn
+		if (!s_headless) s_removedLog.reserve(s_removedLog.capacity() + count);
+	}
+	{	// An entity has one mirror, a few slots cover a removal
+		std::lock_guard<std::mutex> lock(s_worldMutex);
+		if (s_linkScratch.capacity() < 4) s_linkScratch.reserve(4);
+	}
+	Epoch::reserve(count);
+}
+
+// Takes a texture reference that Assets::clear drops at shutdown
+void Engine::keepTexture(const char* path) {
+	if (path && !s_headless) Assets::acquireTexture(path);
+}
+
+// Copies one type's list under the lock
+void Engine::collectType(size_t type, std::vector<Entity*>& out) {
+	std::lock_guard<std::mutex> lock(s_entitiesMutex);
+	if (type < s_typeLists.size()) {
+		out.insert(out.end(), s_typeLists[type].begin(), s_typeLists[type].end());
+	}
+}
+
+// Per thread buffer shared by all live EntityViews on that thread, reused so queries don't allocate
+std::vector<Entity*>& Engine::eachScratch() {
+	thread_local std::vector<Entity*> scratch;
+	return scratch;
+}
+
+// Hands out type indices in first use order
+size_t Engine::nextTypeIndex() {
+	static std::atomic<size_t> next{ 0 };
+	return next++;
+}
+
+/**
+ * Updates every entity once on the calling thread.
+ * Used instead of run() when the caller owns the loop, e.g. a headless simulation.
+ * @param deltaTime The time step to advance each entity by.
+ */
+void Engine::step(float deltaTime) {
+	// Free what was removed last step, then read inside a guard like the worker does
+	Epoch::collect();
+	EpochGuard guard;
+
+	// Reused across steps, the caller owns this thread's frame arena so it can't be used here
+	thread_local std::vector<Entity*> snapshot;
+	getEntitiesSnapshot(snapshot);
+	const uint32_t actions = sampleTickInput();
+	for (Entity* e : snapshot) {
+		if (!e) continue;
+		if (e->isInputControlled()) e->setPendingActions(actions);
+		e->update(deltaTime);
+	}
+	runSystems(deltaTime);
+}
+
+/**
+ * Consumes the input up to now, the end of this tick, and keeps it for takeActions.
+ * @return The actions active during the tick, taps shorter than it included.
+ */
+uint32_t Engine::sampleTickInput() {
+	const ActionSample sample = Input::sampleActions(SDL_GetTicksNS());
+	s_actionsHeld.store(sample.held);
+	s_actionsPressed.fetch_or(sample.pressed);
+	s_actionsReleased.fetch_or(sample.released);
+	return sample.active();
+}
+
+ActionSample Engine::takeActions() {
+	ActionSample sample;
+	sample.held = s_actionsHeld.load();
+	sample.pressed = s_actionsPressed.exchange(0);
+	sample.released = s_actionsReleased.exchange(0);
+	return sample;
+}
+
+// Gets the ECS world
+ecs::World& Engine::getWorld() {
+	return s_world;
+}
+
+// Gets the ECS world mutex
+std::mutex& Engine::getWorldMutex() {
+	return s_worldMutex;
+}
+
+/**
+ * Registers an ECS system. Systems run in the order added, on the update thread, with the world locked.
+ * @param system Called with the world and the step's delta time.
+ */
+void Engine::addSystem(std::function<void(ecs::World&, float)> system) {
+	{
+		std::lock_guard<std::mutex> lock(s_worldMutex);
+		s_systems.push_back(std::move(system));
+	}
+	wakeWorker();
+}
+
+// True if the update thread has entities or systems to run
+bool Engine::hasWork() {
+	{
+		std::lock_guard<std::mutex> lock(s_entitiesMutex);
+		if (!s_entities.empty()) return true;
+	}
+	std::lock_guard<std::mutex> lock(s_worldMutex);
+	return !s_systems.empty();
+}
+
+// Wakes a parked update thread, taking the park mutex so the wake can't slip in before it waits
+void Engine::wakeWorker() {
+	std::lock_guard<std::mutex> lock(s_parkMutex);
+	s_parkCV.notify_all();
+}
+
+// Runs every registered system once
+void Engine::runSystems(float deltaTime) {
+	std::lock_guard<std::mutex> lock(s_worldMutex);
+	for (auto& system : s_systems) {
+		system(s_world, deltaTime);
+	}
+}
+
+// Time the last main loop frame took, in nanoseconds
+uint64_t Engine::getFrameTimeNS() {
+	return s_framePacer.getFrameTimeNS();
+}
+
+// Sets the timeline that drives entity updates, null for the real clock
+void Engine::setTimeline(Timeline* timeline) {
+	s_timeline = timeline;
+}
+
+Timeline* Engine::getTimeline() {
+	return s_timeline;
+}
+
+// Sets the tilemap the main loop streams and draws, null for none
+void Engine::setTilemap(Tilemap* tilemap) {
+	s_tilemap = tilemap;
+}
+
+Tilemap* Engine::getTilemap() {
+	return s_tilemap;
+}
+
+/**
+ * Works out an entity's dt for this update. Entities on their own timeline advance by
+ * that timeline's delta since their last update, the rest by the engine step's dt.
+ * @param entity The entity about to update.
+ * @param deltaTime The engine step's dt.
+ * @return The dt to pass to entity->update().
+ */
+float Engine::entityDelta(Entity* entity, float deltaTime) {
+	Timeline* timeline = entity->timeline;
+	if (!timeline) return deltaTime;
+	const int64_t now = timeline->getTimeNS();
+	const int64_t delta = now - entity->lastTimeNS;
+	entity->lastTimeNS = now;
+	return delta / 1e9f;
+}
+
+// Ends the main loop started by run()
+void Engine::stop() {
+	s_running = false;
+}
+
+/**
+ * Adds a static body. It is drawn like any entity but never updated, and
+ * collision queries find it through the static BVH.
+ * @param entity A pointer to the entity to add.
+ */
+void Engine::addStaticEntity(Entity* entity) {
+	std::unique_lock<std::shared_mutex> lock(s_staticMutex);
+	s_staticEntities.push_back(entity);
+	s_staticDirty = true;
+}
+
+/**
+ * Removes an entity from every engine list and retires it. The memory is freed by a later
+ * Epoch::collect, after the worker, the render loop and any guarded snapshot are done with it.
+ * @param entity The entity to remove, ignored if the engine doesn't hold it.
+ */
+void Engine::removeEntity(Entity* entity) {
+	if (!entity) return;
+
+	bool found = false;
+	{
+		std::lock_guard<std::mutex> lock(s_entitiesMutex);
+		auto it = std::find(s_entities.begin(), s_entities.end(), entity);
+		if (it != s_entities.end()) {
+			s_entities.erase(it); // keeps draw order
+			found = true;
+			// Frames extracted before now still list it, the main loop skips it in those
+			if (!s_headless) s_removedLog.emplace_back(++s_removalStamp, entity);
+		}
+		for (std::vector<Entity*>& list : s_typeLists) {
+			auto typed = std::find(list.begin(), list.end(), entity);
+			if (typed != list.end()) {
+				*typed = list.back(); // type lists are unordered
+				list.pop_back();
+				break;
+			}
+		}
+	}
+	if (!found) {
+		std::unique_lock<std::shared_mutex> lock(s_staticMutex);
+		auto it = std::find(s_staticEntities.begin(), s_staticEntities.end(), entity);
+		if (it != s_staticEntities.end()) {
+			s_staticEntities.erase(it);
+			s_staticDirty = true;
+			found = true;
+		}
+	}
+	if (!found) return;
+
+	{	// Drop any ECS mirror so pushLegacy doesn't write to it
+		std::lock_guard<std::mutex> lock(s_worldMutex);
+		s_linkScratch.clear();
+		s_world.eachWithId<ecs::LegacyLink>([&](ecs::EntityId id, ecs::LegacyLink& link) {
+			if (link.entity == entity) s_linkScratch.push_back(id);
+		});
+		for (ecs::EntityId id : s_linkScratch) s_world.destroy(id);
+	}
+
+	Epoch::retire(entity);
+}
+
+// Flags the static BVH for a rebuild before the next query
+void Engine::markStaticDirty() {
+	s_staticDirty = true;
+}
+
+// Rebuilds the static BVH once after any number of adds or changes
+void Engine::rebuildStaticIfDirty() {
+	if (!s_staticDirty) return;
+	std::unique_lock<std::shared_mutex> lock(s_staticMutex);
+	if (s_staticDirty) {
+		s_staticTree.build(s_staticEntities);
+		s_staticDirty = false;
+	}
+}
+
+/**
+ * Finds static bodies overlapping an area. Concurrent queries share the tree without blocking each other.
+ * @param area The area to search.
+ * @param out Matching static bodies are appended here.
+ */
+void Engine::queryStatic(const SDL_FRect& area, std::vector<Entity*>& out) {
+	rebuildStaticIfDirty();
+	std::shared_lock<std::shared_mutex> lock(s_staticMutex);
+	s_staticTree.query(area, out);
+}
+
+/**
+ * The main game loop. It handles events, updates game state, and renders the scene.
+ * @param update The function to call for game state updates.
+ * @param render The function to call for custom render logic.
+ */
+void Engine::run(std::function<void(float)> update, std::function<void(void)> render) {
+	
+	s_running = true;
+	s_workerRunning = true; 
+
+	// Worker thread: updates all dynamic entities with its own dt (static bodies are never updated)
+	s_updateThread = std::thread([&]() {
+		AllocScope scope(AllocTag::Engine);
+		FrameArena& arena = FrameArena::local();
+		// dt comes from the engine timeline in nanoseconds, a timeline swap restarts the baseline
+		Timeline* timeline = s_timeline;
+		auto clock = [&timeline]() {
+			return timeline ? timeline->getTimeNS() : static_cast<int64_t>(SDL_GetTicksNS());
+		};
+		int64_t last = clock();
+		FramePacer pacer(s_updateRate);
+		while (s_workerRunning) {
+			// Park while there is nothing to update, addEntity/addSystem wake it
+			if (!hasWork()) {
+				std::unique_lock<std::mutex> lock(s_parkMutex);
+				s_parkCV.wait(lock, []() { return !s_workerRunning || hasWork(); });
+				if (!s_workerRunning) break;
+				last = clock(); // the parked time isn't one huge dt
+				pacer.reset();
+			}
+
+			if (s_timeline != timeline) {
+				timeline = s_timeline;
+				last = clock();
+			}
+			const int64_t now = clock();
+			float dt = (now - last) / 1e9f;
+			last = now;
+
+			// Removed entities stay alive until this pass is done with them
+			EpochGuard guard;
+
+			// Take a snapshot under lock, then release the lock before calling update().
+			// It lives in the step's scratch, so copying the list costs no allocation.
+			arena.reset();
+			FrameVector<Entity*> snapshot;
+			getEntitiesSnapshot(snapshot);
+
+			// One input sample per tick, so every tick acts on its own slice of the keyboard
+			const uint32_t actions = sampleTickInput();
+			for (Entity* e : snapshot) {
+				if (!e) continue;
+				if (e->isInputControlled()) e->setPendingActions(actions);
+				e->update(entityDelta(e, dt));
+			}
+			runSystems(dt);
+
+			// Hand this step's results to the renderer
+			if (!s_headless) extractRenderCommands();
+
+			// Hold the fixed update rate instead of spinning
+			pacer.wait();
+		}
+		});
+
+	// Main thread: events, input, game update (network/timeline), render
+	SDL_Event e;
+	std::vector<Entity*> visibleStatics; // reused every frame
+	std::vector<const Entity*> removedSince;
+	Uint64 lastTime = SDL_GetTicksNS();// Get initial time for delta time calculation
+	s_framePacer.reset();
+	while (s_running) {
+		// Wait out the frame budget (or let vsync do it) before sampling input for the next one
+		s_framePacer.wait();
+
+		// Allocations are counted per frame, and last frame's scratch is free again
+		Allocations::nextFrame();
+		FrameArena::local().reset();
+
+		// Free entities removed in earlier frames that no reader can see any more,
+		// then hold a read epoch for the rest of the frame
+		Epoch::collect();
+		EpochGuard guard;
+
+        // Process all pending SDL events
+		while (SDL_PollEvent(&e)) {
+			if (e.type == SDL_EVENT_QUIT) {
+				s_running = false;
+			} 
+			Input::processEvent(e); // key transitions keep their OS timestamps
+		}
+        Input::updateKeyboardState();
+
+        // Calculate delta time
+		Uint64 currentTime = SDL_GetTicksNS();
+		float deltaTime = (currentTime - lastTime) / 1e9f;
+		lastTime = currentTime;
+
+		{
+			AllocScope scope(AllocTag::Game);
+			update(deltaTime);
+		}
+
+		// Follow window resizes, the view is what gets drawn and streamed this frame
+		if (!s_headless) {
+			int w = 0, h = 0;
+			if (SDL_GetRenderOutputSize(s_renderer, &w, &h)) {
+				s_camera.setViewport(static_cast<float>(w), static_cast<float>(h));
+			}
+		}
+		const SDL_FRect view = s_camera.getView();
+
+		// Stream chunks around the view and swap in the ones the loader finished,
+		// headless runs still need them for collision
+		Tilemap* tilemap = s_tilemap;
+		if (tilemap) {
+			tilemap->setFocus(view);
+			tilemap->update();
+		}
+
+		// Nothing to draw without a renderer
+		if (s_headless) continue;
+		AllocScope renderScope(AllocTag::Render);
+
+		SDL_SetRenderDrawColor(s_renderer, 255, 255, 255, 255);  // white background
+		SDL_RenderClear(s_renderer);
+		
+		// Static bodies come from the BVH so off screen level geometry costs nothing.
+		// They never move, so drawing them live doesn't race the update thread.
+		visibleStatics.clear();
+		queryStatic(view, visibleStatics);
+
+		// Level geometry first so moving entities draw on top of it
+		for (Entity* entity : visibleStatics) {
+			entity->draw();
+		}
+		if (tilemap) tilemap->draw(s_renderer, view, s_camera.getScale());
+
+		// Dynamic entities come from the last extracted frame, never from live entity state
+		if (const RenderFrame* frame = s_renderQueue.acquire()) {
+			drawRenderFrame(*frame, removedSince);
+		}
+
+		render(); // font does work with it here
+		SDL_RenderPresent(s_renderer);
+	}
+
+	// Shutdown worker
+	s_workerRunning = false;
+	wakeWorker();
+	if (s_updateThread.joinable()) s_updateThread.join();
+}
+
+/**
+ * Copies the draw data of every textured dynamic entity into the render queue's back frame
+ * and publishes it, sorted by layer. Runs on the update thread once a step has finished, so
+ * the frame is a consistent picture of that step and the main loop never reads live entities.
+ */
+void Engine::extractRenderCommands() {
+	RenderFrame& frame = s_renderQueue.beginFrame();
+	{
+		std::lock_guard<std::mutex> lock(s_entitiesMutex);
+		frame.removalStamp = s_removalStamp;
+		// Room for every entity reserved so far, so a spawn after load doesn't grow the frame
+		frame.commands.reserve(s_entities.capacity());
+		for (const Entity* entity : s_entities) {
+			if (entity && entity->texture) {
+				frame.commands.push_back({ entity, entity->texture, entity->getRect(), entity->layer });
+			}
+		}
+	}
+	// Insertion sort by layer: stable, so equal layers keep the order they were added in, without
+	// the buffer std::stable_sort allocates. Most entities share a layer, so it's close to one pass.
+	std::vector<RenderCommand>& commands = frame.commands;
+	for (size_t i = 1; i < commands.size(); ++i) {
+		const RenderCommand command = commands[i];
+		size_t j = i;
+		for (; j > 0 && commands[j - 1].layer > command.layer; --j) commands[j] = commands[j - 1];
+		commands[j] = command;
+	}
+	s_renderQueue.publish();
+}
+
+/**
+ * Draws an extracted frame through the camera, leaving out entities removed after it was
+ * extracted (their textures may already be released).
+ * @param frame The frame from the render queue.
+ * @param skip Scratch list for the removed entities, reused across frames.
+ */
+void Engine::drawRenderFrame(const RenderFrame& frame, std::vector<const Entity*>& skip) {
+	skip.clear();
+	{
+		std::lock_guard<std::mutex> lock(s_entitiesMutex);
+		// Entries this frame already accounts for are behind every later frame too
+		auto seen = std::find_if(s_removedLog.begin(), s_removedLog.end(),
+			[&frame](const std::pair<uint64_t, const Entity*>& removed) { return removed.first > frame.removalStamp; });
+		s_removedLog.erase(s_removedLog.begin(), seen);
+		for (const auto& removed : s_removedLog) skip.push_back(removed.second);
+	}
+
+	for (const RenderCommand& command : frame.commands) {
+		if (!s_camera.isVisible(command.rect)) continue;
+		if (!skip.empty() && std::find(skip.begin(), skip.end(), command.source) != skip.end()) continue;
+		const SDL_FRect dst = s_camera.worldToScreen(command.rect);
+		SDL_RenderTexture(s_renderer, command.texture, nullptr, &dst);
+	}
+}
+
+/**
+ * Provides access to the global SDL renderer instance.
+ * @return A pointer to the SDL_Renderer.
+ */
+SDL_Renderer* Engine::getRenderer() {
+	return s_renderer;
+}
+
+// Check if the engine is running without a window
+bool Engine::isHeadless() {
+	return s_headless;
+}
+
+// Gets the camera the main loop draws through
+Camera& Engine::getCamera() {
+	return s_camera;
+}
+
+// Gets the entity mutex
+std::mutex& Engine::getEntitiesMutex() { 
+	return s_entitiesMutex; 
+}
+
+// Deadlock safe get entities
+std::vector<Entity*> Engine::getEntitiesSnapshot() {
+	std::lock_guard<std::mutex> lock(s_entitiesMutex);
+	return s_entities; // copy
+}
+
+/**
+ * Provides access to the list of entities managed by the engine.
+ * @return A constant reference to the vector of entity pointers.
+ */
+ //const std::vector<Entity*>& Engine::getEntities() {
+	 //std::lock_guard<std::mutex> lock(s_entitiesMutex); // lock for getting entities
+	 //return s_entities;
+ //}
@@ -0,0 +1,118 @@
+#include <engine/Epoch.h>
+#include <engine/Pool.h>
+#include <algorithm>
+#include <iostream>
+
+// Epoch 0 means "not reading", so counting starts at 1
+std::atomic<uint64_t> Epoch::s_epoch{ 1 };
+Epoch::Slot Epoch::s_slots[Epoch::kMaxThreads];
+std::vector<Epoch::Retired> Epoch::s_retired;
+std::mutex Epoch::s_retiredMutex;
+std::vector<Entity*> Epoch::s_ready;
+std::mutex Epoch::s_collectMutex;
+
+namespace {
+	// Guard nesting on this thread, only the outermost one publishes an epoch
+	thread_local int t_depth = 0;
+	thread_local int t_slot = -1;
+}
+
+/**
+ * Claims a reader slot for the calling thread on first use.
+ * @return The slot index, or -1 if every slot is taken.
+ */
+int Epoch::threadSlot() {
+	if (t_slot >= 0) return t_slot;
+	for (int i = 0; i < kMaxThreads; ++i) {
+		bool expected = false;
+		if (s_slots[i].used.compare_exchange_strong(expected, true)) {
+			t_slot = i;
+			return i;
+		}
+	}
+	std::cerr << "Epoch: out of reader slots" << std::endl;
+	return -1;
+}
+
+void Epoch::enter() {
+	if (t_depth++ > 0) return;
+	const int slot = threadSlot();
+	if (slot < 0) return;
+	// Publish before reading any entity list, seq_cst so collect() can't miss it
+	s_slots[slot].epoch.store(s_epoch.load());
+}
+
+void Epoch::exit() {
+	if (--t_depth > 0) return;
+	if (t_slot >= 0) s_slots[t_slot].epoch.store(0);
+}
+
+/**
+ * Retires an entity that was just removed from every engine list.
+ * @param entity The entity to free later.
+ */
+void Epoch::retire(Entity* entity) {
+	if (!entity) return;
+	std::lock_guard<std::mutex> lock(s_retiredMutex);
+	s_retired.push_back({ entity, s_epoch.load() });
+}
+
+void Epoch::reserve(size_t count) {
+	std::lock_guard<std::mutex> collectLock(s_collectMutex);
+	std::lock_guard<std::mutex> lock(s_retiredMutex);
+	s_retired.reserve(s_retired.capacity() + count);
+	s_ready.reserve(s_ready.capacity() + count);
+}
+
+/**
+ * Frees entities retired before the oldest epoch any reader is in, then starts a new epoch.
+ * A reader that entered later than an entity's retire epoch got its pointers from lists that
+ * no longer held the entity, so it can't see it.
+ * @return The number of entities freed.
+ */
+size_t Epoch::collect() {
+	std::lock_guard<std::mutex> collectLock(s_collectMutex);
+	s_ready.clear();
+	{
+		std::lock_guard<std::mutex> lock(s_retiredMutex);
+		if (s_retired.empty()) {
+			s_epoch.fetch_add(1);
+			return 0;
+		}
+
+		// Oldest epoch still being read
+		uint64_t oldest = s_epoch.load();
+		for (const Slot& slot : s_slots) {
+			const uint64_t e = slot.epoch.load();
+			if (e != 0 && e < oldest) oldest = e;
+		}
+
+		auto freeFrom = std::partition(s_retired.begin(), s_retired.end(),
+			[oldest](const Retired& r) { return r.epoch >= oldest; });
+		for (auto it = freeFrom; it != s_retired.end(); ++it) s_ready.push_back(it->entity);
+		s_retired.erase(freeFrom, s_retired.end());
+		s_epoch.fetch_add(1);
+	}
+
+	// Destructors run outside the lock, they may release textures or pool slots
+	for (Entity* entity : s_ready) {
+		PoolBase::free(entity);
+	}
+	return s_ready.size();
+}
+
+size_t Epoch::pending() {
+	std::lock_guard<std::mutex> lock(s_retiredMutex);
+	return s_retired.size();
+}
+
+void Epoch::drain() {
+	std::vector<Retired> all;
+	{
+		std::lock_guard<std::mutex> lock(s_retiredMutex);
+		all.swap(s_retired);
+	}
+	for (const Retired& r : all) {
+		PoolBase::free(r.entity);
+	}
+}
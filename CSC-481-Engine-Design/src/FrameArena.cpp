@@ -0,0 +1,66 @@
+#include <engine/FrameArena.h>
+#include <algorithm>
+
+/**
+ * Creates an arena.
+ * @param capacity Size of the main block in bytes, it grows to fit the busiest frame.
+ */
+FrameArena::FrameArena(size_t capacity) : blockSize(capacity) {
+	block = static_cast<char*>(::operator new(blockSize));
+}
+
+FrameArena::~FrameArena() {
+	reset(); // frees the overflow blocks
+	::operator delete(block);
+}
+
+/**
+ * Bumps the offset past an aligned allocation, spilling into a block of its own when the
+ * main block is full.
+ * @param size Bytes wanted.
+ * @param alignment A power of two.
+ * @return The memory, never null.
+ */
+void* FrameArena::allocate(size_t size, size_t alignment) {
+	const uintptr_t base = reinterpret_cast<uintptr_t>(block);
+	const size_t start = ((base + offset + alignment - 1) & ~(alignment - 1)) - base;
+	if (start + size <= blockSize) {
+		offset = start + size;
+		return block + start;
+	}
+
+	// ::operator new aligns for max_align_t, pad anything stricter
+	const size_t padded = size + (alignment > alignof(std::max_align_t) ? alignment : 0);
+	char* extra = static_cast<char*>(::operator new(padded));
+	overflow.push_back(extra);
+	spilled += padded;
+	const uintptr_t aligned = (reinterpret_cast<uintptr_t>(extra) + alignment - 1) & ~(alignment - 1);
+	return reinterpret_cast<void*>(aligned);
+}
+
+// Rewinds the block, and if the frame spilled, regrows it to hold the whole frame next time
+void FrameArena::reset() {
+	for (char* extra : overflow) ::operator delete(extra);
+	overflow.clear();
+	if (spilled > 0) {
+		const size_t wanted = std::max(blockSize * 2, offset + spilled);
+		::operator delete(block);
+		block = static_cast<char*>(::operator new(wanted));
+		blockSize = wanted;
+		spilled = 0;
+	}
+	offset = 0;
+}
+
+size_t FrameArena::used() const {
+	return offset + spilled;
+}
+
+size_t FrameArena::capacity() const {
+	return blockSize;
+}
+
+FrameArena& FrameArena::local() {
+	thread_local FrameArena arena;
+	return arena;
+}
@@ -0,0 +1,89 @@
+#include <engine/FramePacer.h>
+#include <algorithm>
+#include <thread>
+
+/**
+ * Creates a pacer.
+ * @param targetHz Frames per second to hold, or 0 for no pacing.
+ */
+FramePacer::FramePacer(double targetHz) {
+	setTargetRate(targetHz);
+}
+
+void FramePacer::setTargetRate(double hz) {
+	periodNS = hz > 0.0 ? static_cast<uint64_t>(1e9 / hz) : 0;
+	reset();
+}
+
+double FramePacer::getTargetRate() const {
+	return periodNS > 0 ? 1e9 / periodNS : 0.0;
+}
+
+void FramePacer::setVsync(double refreshHz) {
+	vsyncPeriodNS = refreshHz > 0.0 ? static_cast<uint64_t>(1e9 / refreshHz) : 0;
+}
+
+void FramePacer::reset() {
+	nextDeadlineNS = 0;
+	lastFrameStartNS = 0;
+}
+
+/**
+ * Waits out the rest of the current frame.
+ * The first call only starts the schedule.
+ */
+void FramePacer::wait() {
+	// vsync already holds the loop to the display, pacing on top would only add a frame of lag.
+	// Allow a little slack so a 60 Hz target on a 59.94 Hz display counts as matching.
+	const bool paced = periodNS > 0 && !(vsyncPeriodNS > 0 && periodNS <= vsyncPeriodNS + vsyncPeriodNS / 50);
+
+	if (paced && nextDeadlineNS != 0) {
+		const uint64_t late = sleepUntilNS(nextDeadlineNS, spinMarginNS);
+		// Track the wake up error: jump up to a bad wake at once, drift down slowly
+		const uint64_t wanted = std::clamp(late + late / 4, kMinSpinNS, kMaxSpinNS);
+		spinMarginNS = wanted > spinMarginNS ? wanted : spinMarginNS - (spinMarginNS - wanted) / 16;
+	}
+
+	const uint64_t now = SDL_GetTicksNS();
+	frameTimeNS = lastFrameStartNS ? now - lastFrameStartNS : 0;
+	lastFrameStartNS = now;
+
+	if (!paced) return;
+	if (nextDeadlineNS == 0 || now > nextDeadlineNS + periodNS) {
+		nextDeadlineNS = now + periodNS; // start over rather than burst
+	}
+	else {
+		nextDeadlineNS += periodNS; // stay on the grid so the average rate is exact
+	}
+}
+
+uint64_t FramePacer::getFrameTimeNS() const {
+	return frameTimeNS;
+}
+
+uint64_t FramePacer::getSpinMarginNS() const {
+	return spinMarginNS;
+}
+
+/**
+ * Waits until a deadline with a coarse sleep followed by a spin.
+ * @param deadlineNS The SDL_GetTicksNS time to wake at.
+ * @param spinMarginNS How long before the deadline the sleep should end.
+ * @return How far past its target the sleep woke, 0 if there was no time to sleep.
+ */
+uint64_t FramePacer::sleepUntilNS(uint64_t deadlineNS, uint64_t spinMarginNS) {
+	uint64_t now = SDL_GetTicksNS();
+	uint64_t late = 0;
+	if (deadlineNS > now + spinMarginNS) {
+		const uint64_t target = deadlineNS - spinMarginNS;
+		SDL_DelayNS(target - now);
+		now = SDL_GetTicksNS();
+		late = now > target ? now - target : 0;
+	}
+	// Spin out the rest, yielding so a sibling thread on the same core can run
+	while (now < deadlineNS) {
+		std::this_thread::yield();
+		now = SDL_GetTicksNS();
+	}
+	return late;
+}
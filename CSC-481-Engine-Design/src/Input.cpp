@@ -1,53 +1,135 @@
-#include <engine/Input.h>
-#include <SDL3/SDL.h>
-
-// Initializes the static keyboardState pointer to null.
-// This pointer will be used by SDL with the current keyboard state.
-const bool* Input::keyboardState = nullptr;
-
-// Key map
-std::unordered_map<SDL_Scancode, uint32_t> Input::keyBindings;
-
-/**
- * Updates the internal keyboard state by getting the latest state.
- * This function should be called once per frame in the main game loop
- * to ensure that the keyboard state is always up-to-date.
- */
-void Input::updateKeyboardState() {
-    keyboardState = SDL_GetKeyboardState(nullptr);
-}
-
-/**
- * Checks the stored keyboard state to see if a specific key is pressed.
- * @param key The SDL_Scancode of the key to check.
- * @return true if the key is currently pressed, false otherwise.
- */
-bool Input::isKeyPressed(SDL_Scancode key) {
-    if (keyboardState != nullptr) {
-        return keyboardState[key];
-    }
-    return false;
-}
-
-// Bind key to bit
-void Input::bindAction(SDL_Scancode key, uint32_t bit) {
-	keyBindings[key] = bit;
-}
-
-// Clear key to bit bindings
-void Input::clearBindings() {
-	keyBindings.clear();
-}
-
-// Get the action mask for the game
-uint32_t Input::getActionMask() {
-	uint32_t mask = 0;
-	if (keyboardState != nullptr) {
-		for (auto& [key, bit] : keyBindings) {
-			if (keyboardState[key]) {
-				mask |= (1u << bit);
-			}
-		}
-	}
-	return mask;
-}
+#include <engine/Input.h>
+#include <SDL3/SDL.h>
+
+// Initializes the static keyboardState pointer to null.
+// This pointer will be used by SDL with the current keyboard state.
+const bool* Input::keyboardState = nullptr;
+
+// Key table and event state
+uint32_t Input::keyBindings[SDL_SCANCODE_COUNT] = {};
+bool Input::keyDown[SDL_SCANCODE_COUNT] = {};
+Input::KeyEvent Input::queue[Input::kQueueSize];
+uint32_t Input::queueHead = 0;
+uint32_t Input::queueCount = 0;
+uint8_t Input::heldCount[32] = {};
+uint32_t Input::pendingPressed = 0;
+uint32_t Input::pendingReleased = 0;
+std::mutex Input::inputMutex;
+
+/**
+ * Updates the internal keyboard state by getting the latest state.
+ * This function should be called once per frame in the main game loop
+ * to ensure that the keyboard state is always up-to-date.
+ */
+void Input::updateKeyboardState() {
+    keyboardState = SDL_GetKeyboardState(nullptr);
+}
+
+/**
+ * Checks the stored keyboard state to see if a specific key is pressed.
+ * @param key The SDL_Scancode of the key to check.
+ * @return true if the key is currently pressed, false otherwise.
+ */
+bool Input::isKeyPressed(SDL_Scancode key) {
+    if (keyboardState != nullptr) {
+        return keyboardState[key];
+    }
+    return false;
+}
+
+/**
+ * Queues a key transition from an SDL event. Repeats are dropped, and losing focus
+ * releases every held key since SDL won't send the key up events.
+ * @param event The event from SDL_PollEvent.
+ */
+void Input::processEvent(const SDL_Event& event) {
+	std::lock_guard<std::mutex> lock(inputMutex);
+
+	if (event.type == SDL_EVENT_WINDOW_FOCUS_LOST) {
+		const uint64_t now = SDL_GetTicksNS();
+		for (int key = 0; key < SDL_SCANCODE_COUNT; ++key) {
+			if (!keyDown[key]) continue;
+			keyDown[key] = false;
+			push({ now, keyBindings[key], false });
+		}
+		return;
+	}
+
+	if (event.type != SDL_EVENT_KEY_DOWN && event.type != SDL_EVENT_KEY_UP) return;
+	const SDL_Scancode key = event.key.scancode;
+	if (key < 0 || key >= SDL_SCANCODE_COUNT || event.key.repeat) return;
+	if (keyDown[key] == event.key.down) return; // no change
+	keyDown[key] = event.key.down;
+
+	push({ event.key.timestamp, keyBindings[key], event.key.down });
+}
+
+// Appends a transition, caller holds inputMutex
+void Input::push(const KeyEvent& event) {
+	// Full queue: fold the oldest transition into the state so no edge is lost, only its timing
+	if (queueCount == kQueueSize) {
+		applyEvent(queue[queueHead]);
+		queueHead = (queueHead + 1) % kQueueSize;
+		--queueCount;
+	}
+	queue[(queueHead + queueCount++) % kQueueSize] = event;
+}
+
+// Updates the per bit hold counts with one transition and records its edges
+void Input::applyEvent(const KeyEvent& event) {
+	for (int bit = 0; bit < 32; ++bit) {
+		if (!(event.mask & (1u << bit))) continue;
+		if (event.down) {
+			if (heldCount[bit]++ == 0) pendingPressed |= (1u << bit);
+		}
+		else if (heldCount[bit] > 0) {
+			if (--heldCount[bit] == 0) pendingReleased |= (1u << bit);
+		}
+	}
+}
+
+// Bind key to bit
+void Input::bindAction(SDL_Scancode key, uint32_t bit) {
+	if (key < 0 || key >= SDL_SCANCODE_COUNT || bit >= 32) return;
+	std::lock_guard<std::mutex> lock(inputMutex);
+	keyBindings[key] = (1u << bit);
+}
+
+// Clear key to bit bindings
+void Input::clearBindings() {
+	std::lock_guard<std::mutex> lock(inputMutex);
+	for (uint32_t& mask : keyBindings) mask = 0;
+	for (uint8_t& count : heldCount) count = 0;
+	pendingPressed = 0;
+	pendingReleased = 0;
+}
+
+/**
+ * Consumes the queued transitions that happened up to a point in time.
+ * Later transitions stay queued for the next window.
+ * @param untilNS End of the window, in SDL_GetTicksNS time.
+ * @return The held actions at the end of the window and the edges inside it.
+ */
+ActionSample Input::sampleActions(uint64_t untilNS) {
+	std::lock_guard<std::mutex> lock(inputMutex);
+	while (queueCount > 0 && queue[queueHead].timeNS <= untilNS) {
+		applyEvent(queue[queueHead]);
+		queueHead = (queueHead + 1) % kQueueSize;
+		--queueCount;
+	}
+
+	ActionSample sample;
+	for (int bit = 0; bit < 32; ++bit) {
+		if (heldCount[bit] > 0) sample.held |= (1u << bit);
+	}
+	sample.pressed = pendingPressed;
+	sample.released = pendingReleased;
+	pendingPressed = 0;
+	pendingReleased = 0;
+	return sample;
+}
+
+// Get the action mask for the game
+uint32_t Input::getActionMask() {
+	return sampleActions(SDL_GetTicksNS()).active();
+}
@@ -0,0 +1,127 @@
+#include <engine/MappedFile.h>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+	swap(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+	if (this != &other) {
+		close();
+		swap(other);
+	}
+	return *this;
+}
+
+void MappedFile::swap(MappedFile& other) noexcept {
+	std::swap(bytes, other.bytes);
+	std::swap(length, other.length);
+	std::swap(fileHandle, other.fileHandle);
+	std::swap(mappingHandle, other.mappingHandle);
+	std::swap(fd, other.fd);
+}
+
+/**
+ * Maps a file read-only into memory.
+ * An empty file opens successfully with a null data pointer and size 0.
+ * @param path The file to map.
+ * @return true if the file is mapped, false otherwise.
+ */
+bool MappedFile::open(const std::string& path) {
+	close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+	fileHandle = file;
+	length = static_cast<size_t>(fileSize.QuadPart);
+	if (length == 0) return true;
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		close();
+		return false;
+	}
+	mappingHandle = mapping;
+
+	bytes = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (!bytes) {
+		close();
+		return false;
+	}
+#else
+	fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close();
+		return false;
+	}
+	length = static_cast<size_t>(st.st_size);
+	if (length == 0) return true;
+
+	void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (mapped == MAP_FAILED) {
+		close();
+		return false;
+	}
+	bytes = static_cast<const char*>(mapped);
+#endif
+	return true;
+}
+
+// Unmap the view and close the handles
+void MappedFile::close() {
+#ifdef _WIN32
+	if (bytes) UnmapViewOfFile(bytes);
+	if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+	if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+#else
+	if (bytes) munmap(const_cast<char*>(bytes), length);
+	if (fd >= 0) ::close(fd);
+#endif
+	bytes = nullptr;
+	length = 0;
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+	fd = -1;
+}
+
+bool MappedFile::isOpen() const {
+	return fd >= 0 || fileHandle != nullptr;
+}
+
+const char* MappedFile::data() const {
+	return bytes;
+}
+
+size_t MappedFile::size() const {
+	return length;
+}
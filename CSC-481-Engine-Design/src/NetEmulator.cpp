@@ -0,0 +1,89 @@
+#include <engine/NetEmulator.h>
+#include <algorithm>
+
+size_t EmulatedMessage::bytes() const {
+	size_t total = 0;
+	for (const std::string& frame : frames) total += frame.size();
+	return total;
+}
+
+LinkEmulator::LinkEmulator(uint32_t seed) : rng(seed) {
+}
+
+void LinkEmulator::setConditions(const LinkConditions& c) {
+	conditions = c;
+}
+
+const LinkConditions& LinkEmulator::getConditions() const {
+	return conditions;
+}
+
+// Heap order for std::push_heap, the soonest message ends up on top
+bool LinkEmulator::later(const Pending& a, const Pending& b) {
+	if (a.dueNS != b.dueNS) return a.dueNS > b.dueNS;
+	return a.order > b.order;
+}
+
+bool LinkEmulator::submit(EmulatedMessage&& message, uint64_t nowNS) {
+	std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+	++stats.submitted;
+
+	if (conditions.loss > 0.0f && chance(rng) < conditions.loss) {
+		++stats.lost;
+		return false;
+	}
+
+	// The cap sends one message at a time, each leaves once everything before it has
+	uint64_t sentNS = nowNS;
+	if (conditions.rateKbps > 0.0f) {
+		const uint64_t startNS = std::max(linkFreeNS, nowNS);
+		if (startNS - nowNS > static_cast<uint64_t>(conditions.queueMs * 1e6)) {
+			++stats.overflowed;
+			return false;
+		}
+		linkFreeNS = startNS + static_cast<uint64_t>(message.bytes() * 8e6 / conditions.rateKbps);
+		sentNS = linkFreeNS;
+	}
+
+	uint64_t dueNS = sentNS + static_cast<uint64_t>((conditions.delayMs + conditions.jitterMs * chance(rng)) * 1e6);
+	if (conditions.reorder > 0.0f && chance(rng) < conditions.reorder) {
+		// Held back without moving lastDueNS, so the messages after it can go first
+		dueNS += static_cast<uint64_t>(conditions.reorderMs * 1e6);
+		++stats.reordered;
+	}
+	else {
+		dueNS = std::max(dueNS, lastDueNS);
+		lastDueNS = dueNS;
+	}
+
+	heap.push_back({ dueNS, nextOrder++, std::move(message) });
+	std::push_heap(heap.begin(), heap.end(), later);
+	return true;
+}
+
+bool LinkEmulator::take(uint64_t nowNS, EmulatedMessage& out) {
+	if (heap.empty() || heap.front().dueNS > nowNS) return false;
+	std::pop_heap(heap.begin(), heap.end(), later);
+	out = std::move(heap.back().message);
+	heap.pop_back();
+
+	++stats.delivered;
+	stats.bytes += out.bytes();
+	return true;
+}
+
+int LinkEmulator::msUntilNext(uint64_t nowNS) const {
+	if (heap.empty()) return -1;
+	if (heap.front().dueNS <= nowNS) return 0;
+	return static_cast<int>((heap.front().dueNS - nowNS + 999999) / 1000000);
+}
+
+size_t LinkEmulator::queued() const {
+	return heap.size();
+}
+
+LinkStats LinkEmulator::takeStats() {
+	LinkStats taken = stats;
+	stats = LinkStats();
+	return taken;
+}
@@ -1,53 +1,172 @@
-#include <engine/Physics.h>
-#include <engine/Types.h>
-#include <engine/Entity.h>
-#include <cmath>
-
-// Static gravity value
-float Physics::gravityWeight = 9.81f;
-
-/**
- * Sets the global gravity weight.
- * @param gravity The new gravity value.
- */
-void Physics::setGravity(float gravity) {
-    gravityWeight = gravity;
-}
-
-/**
- * Gets the current global gravity weight.
- * @return The current gravity value.
- */
-float Physics::getGravity() {
-    return gravityWeight;
-}
-
-/**
- * Applies gravity to an entity by adjusting its vertical velocity.
- * This function is called every frame for each entity that is affected by gravity.
- * @param entity A pointer to the entity to apply gravity to.
- * @param deltaTime The time elapsed since the last frame, used to make the physics
- * simulation independent of the frame rate.
- */
-void Physics::apply(Entity* entity, float deltaTime) {
-    if (entity && entity->isAffectedByGravity()) {
-        Velocity v = entity->getVelocity();
-        // Convert velocity vector to components
-        float vx = v.direction.x * v.magnitude;
-        float vy = v.direction.y * v.magnitude;
-        // Add gravity acceleration to vertical component (positive Y is down)
-        vy += gravityWeight * deltaTime;
-        // Recalculate magnitude and normalize direction
-        float mag = std::sqrt(vx * vx + vy * vy);
-        if (mag > 0.0001f) {
-            v.direction.x = vx / mag;
-            v.direction.y = vy / mag;
-            v.magnitude = mag;
-        } else {
-            v.direction.x = 0.0f;
-            v.direction.y = 0.0f;
-            v.magnitude = 0.0f;
-        }
-        entity->setVelocity(v);
-    }
-}
+#include <engine/Physics.h>
+#include <engine/Types.h>
+#include <engine/Entity.h>
+
+// SIMD kernels work on two interleaved {x, y} bodies per 128 bit register
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PHYSICS_SIMD_SSE 1
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#define PHYSICS_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+static_assert(sizeof(OrderedPair) == 2 * sizeof(float), "OrderedPair arrays are loaded as packed floats");
+
+// Static gravity value
+float Physics::gravityWeight = 9.81f;
+
+// Static integrator selection
+Physics::Integrator Physics::integrator = Physics::Integrator::SemiImplicitEuler;
+
+/**
+ * Sets the global gravity weight.
+ * @param gravity The new gravity value.
+ */
+void Physics::setGravity(float gravity) {
+    gravityWeight = gravity;
+}
+
+/**
+ * Gets the current global gravity weight.
+ * @return The current gravity value.
+ */
+float Physics::getGravity() {
+    return gravityWeight;
+}
+
+/**
+ * Gets gravity as an acceleration vector.
+ * @return The acceleration bodies affected by gravity fall with.
+ */
+OrderedPair Physics::getGravityAcceleration() {
+    return { 0.0f, gravityWeight };
+}
+
+/**
+ * Selects the integrator used by every integrate call.
+ * @param selected Semi-implicit Euler or velocity Verlet.
+ */
+void Physics::setIntegrator(Integrator selected) {
+    integrator = selected;
+}
+
+Physics::Integrator Physics::getIntegrator() {
+    return integrator;
+}
+
+/**
+ * Applies gravity to an entity by adjusting its vertical velocity.
+ * Velocities are stored as components, so this is a single multiply-add.
+ * @param entity A pointer to the entity to apply gravity to.
+ * @param deltaTime The time elapsed since the last frame, used to make the physics
+ * simulation independent of the frame rate.
+ */
+void Physics::apply(Entity* entity, float deltaTime) {
+    if (entity && entity->isAffectedByGravity()) {
+        OrderedPair v = entity->getVelocityComponents();
+        // Add gravity acceleration to vertical component (positive Y is down)
+        v.y += gravityWeight * deltaTime;
+        entity->setVelocityComponents(v);
+    }
+}
+
+/**
+ * Advances one body under a constant acceleration with the selected integrator.
+ * @param position The body position, updated in place.
+ * @param velocity The body velocity components, updated in place.
+ * @param acceleration The acceleration acting on the body.
+ * @param deltaTime The time step.
+ */
+void Physics::integrate(OrderedPair& position, OrderedPair& velocity, OrderedPair acceleration, float deltaTime) {
+    const float dvx = acceleration.x * deltaTime;
+    const float dvy = acceleration.y * deltaTime;
+    if (integrator == Integrator::Verlet) {
+        position.x += (velocity.x + 0.5f * dvx) * deltaTime;
+        position.y += (velocity.y + 0.5f * dvy) * deltaTime;
+        velocity.x += dvx;
+        velocity.y += dvy;
+    }
+    else {
+        velocity.x += dvx;
+        velocity.y += dvy;
+        position.x += velocity.x * deltaTime;
+        position.y += velocity.y * deltaTime;
+    }
+}
+
+/**
+ * Advances a run of bodies stored in contiguous arrays.
+ * The arrays are treated as packed floats {x0, y0, x1, y1, ...}, so one SIMD register
+ * holds two bodies and the whole step is a few multiply-adds per body.
+ * @param positions The body positions, updated in place.
+ * @param velocities The body velocity components, updated in place.
+ * @param count How many bodies to advance.
+ * @param acceleration The acceleration acting on every body.
+ * @param deltaTime The time step.
+ */
+void Physics::integrate(OrderedPair* positions, OrderedPair* velocities, size_t count,
+                        OrderedPair acceleration, float deltaTime) {
+    float* p = reinterpret_cast<float*>(positions);
+    float* v = reinterpret_cast<float*>(velocities);
+    const bool verlet = integrator == Integrator::Verlet;
+    const float dvx = acceleration.x * deltaTime;
+    const float dvy = acceleration.y * deltaTime;
+    size_t i = 0;
+
+#if defined(PHYSICS_SIMD_SSE)
+    const __m128 dt = _mm_set1_ps(deltaTime);
+    const __m128 dv = _mm_setr_ps(dvx, dvy, dvx, dvy);
+    const __m128 halfDv = _mm_mul_ps(dv, _mm_set1_ps(0.5f));
+    for (; i + 2 <= count; i += 2) {
+        __m128 pos = _mm_loadu_ps(p + 2 * i);
+        __m128 vel = _mm_loadu_ps(v + 2 * i);
+        if (verlet) {
+#if defined(__FMA__)
+            pos = _mm_fmadd_ps(_mm_add_ps(vel, halfDv), dt, pos);
+#else
+            pos = _mm_add_ps(pos, _mm_mul_ps(_mm_add_ps(vel, halfDv), dt));
+#endif
+            vel = _mm_add_ps(vel, dv);
+        }
+        else {
+            vel = _mm_add_ps(vel, dv);
+#if defined(__FMA__)
+            pos = _mm_fmadd_ps(vel, dt, pos);
+#else
+            pos = _mm_add_ps(pos, _mm_mul_ps(vel, dt));
+#endif
+        }
+        _mm_storeu_ps(p + 2 * i, pos);
+        _mm_storeu_ps(v + 2 * i, vel);
+    }
+#elif defined(PHYSICS_SIMD_NEON)
+    const float32x4_t dt = vdupq_n_f32(deltaTime);
+    const float dvArray[4] = { dvx, dvy, dvx, dvy };
+    const float32x4_t dv = vld1q_f32(dvArray);
+    const float32x4_t halfDv = vmulq_n_f32(dv, 0.5f);
+    for (; i + 2 <= count; i += 2) {
+        float32x4_t pos = vld1q_f32(p + 2 * i);
+        float32x4_t vel = vld1q_f32(v + 2 * i);
+        if (verlet) {
+            pos = vmlaq_f32(pos, vaddq_f32(vel, halfDv), dt);
+            vel = vaddq_f32(vel, dv);
+        }
+        else {
+            vel = vaddq_f32(vel, dv);
+            pos = vmlaq_f32(pos, vel, dt);
+        }
+        vst1q_f32(p + 2 * i, pos);
+        vst1q_f32(v + 2 * i, vel);
+    }
+#endif
+
+    // Scalar tail (and the whole run without SIMD)
+    for (; i < count; ++i) {
+        integrate(positions[i], velocities[i], acceleration, deltaTime);
+    }
+}
+
+void Physics::integrate(BodyBatch& batch, OrderedPair acceleration, float deltaTime) {
+    integrate(batch.positions.data(), batch.velocities.data(), batch.size(), acceleration, deltaTime);
+}
@@ -0,0 +1,21 @@
+#include <engine/Pool.h>
+#include <engine/Entity.h>
+
+/**
+ * Frees an entity the way it was allocated.
+ * @param entity The entity to free, may be null.
+ */
+void PoolBase::free(Entity* entity) {
+	if (!entity) return;
+	if (entity->ownerPool) {
+		entity->ownerPool->releaseEntity(entity);
+	}
+	else {
+		delete entity;
+	}
+}
+
+// Called by Pool<T>::create so free() can find the pool later
+void PoolBase::setOwner(Entity* entity, PoolBase* pool) {
+	entity->ownerPool = pool;
+}
@@ -0,0 +1,53 @@
+#include <engine/PositionHistory.h>
+#include <algorithm>
+
+PositionHistory::PositionHistory(int ticks, int perTick)
+	: frames(static_cast<size_t>(std::max(ticks, 1))), perTick(static_cast<size_t>(std::max(perTick, 1))) {
+	for (Frame& frame : frames) frame.boxes.reserve(this->perTick);
+}
+
+void PositionHistory::beginTick(int tick) {
+	Frame& frame = frames[static_cast<size_t>(tick) % frames.size()];
+	frame.tick = tick;
+	frame.boxes.clear();
+	newestTick = tick;
+	recorded = std::min(recorded + 1, static_cast<int>(frames.size()));
+}
+
+void PositionHistory::record(int id, const SDL_FRect& rect) {
+	if (newestTick < 0) return;
+	Frame& frame = frames[static_cast<size_t>(newestTick) % frames.size()];
+	if (frame.boxes.size() < perTick) frame.boxes.push_back({ id, rect });
+}
+
+// The frame holding a tick, null if it has been overwritten or was never recorded
+const PositionHistory::Frame* PositionHistory::frameOf(int tick) const {
+	if (tick < 0) return nullptr;
+	const Frame& frame = frames[static_cast<size_t>(tick) % frames.size()];
+	return frame.tick == tick ? &frame : nullptr;
+}
+
+bool PositionHistory::find(int tick, int id, SDL_FRect& out) const {
+	const Frame* frame = frameOf(tick);
+	if (!frame) return false;
+	for (const HistoryBox& box : frame->boxes) {
+		if (box.id == id) {
+			out = box.rect;
+			return true;
+		}
+	}
+	return false;
+}
+
+int PositionHistory::clamp(int tick) const {
+	if (newestTick < 0) return -1;
+	return std::min(std::max(tick, oldest()), newestTick);
+}
+
+int PositionHistory::newest() const {
+	return newestTick;
+}
+
+int PositionHistory::oldest() const {
+	return newestTick < 0 ? -1 : newestTick - recorded + 1;
+}
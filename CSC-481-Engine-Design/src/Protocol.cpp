@@ -0,0 +1,318 @@
+#include <engine/Protocol.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Parses the whitespace separated fields of one message in place.
+// The message is copied into a per thread buffer to null terminate it, the buffer keeps its
+// capacity so steady state decoding doesn't allocate.
+class FieldReader {
+public:
+	FieldReader(const char* data, size_t size) {
+		thread_local std::string buffer;
+		buffer.assign(data, size);
+		cursor = buffer.c_str();
+		last = cursor + size;
+	}
+
+	// Bytes not read yet
+	size_t remaining() const { return static_cast<size_t>(last - cursor); }
+
+	bool tag(const char* expected) {
+		skipSpace();
+		const size_t n = std::strlen(expected);
+		if (std::strncmp(cursor, expected, n) != 0 || !isEnd(cursor[n])) return false;
+		cursor += n;
+		return true;
+	}
+
+	// True once every field has been read
+	bool done() {
+		skipSpace();
+		return *cursor == '\0';
+	}
+
+	bool read(int& out) {
+		long value;
+		if (!number(value, std::strtol)) return false;
+		out = static_cast<int>(value);
+		return true;
+	}
+
+	bool read(uint32_t& out) {
+		unsigned long value;
+		if (!number(value, std::strtoul)) return false;
+		out = static_cast<uint32_t>(value);
+		return true;
+	}
+
+	bool read(float& out) {
+		skipSpace();
+		char* end = nullptr;
+		const float value = std::strtof(cursor, &end);
+		if (end == cursor || !isEnd(*end)) return false;
+		out = value;
+		cursor = end;
+		return true;
+	}
+
+private:
+	template<class T>
+	bool number(T& out, T (*parse)(const char*, char**, int)) {
+		skipSpace();
+		char* end = nullptr;
+		const T value = parse(cursor, &end, 10);
+		if (end == cursor || !isEnd(*end)) return false;
+		out = value;
+		cursor = end;
+		return true;
+	}
+
+	static bool isEnd(char c) { return c == '\0' || c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+	void skipSpace() { while (*cursor && isEnd(*cursor)) ++cursor; }
+
+	const char* cursor;
+	const char* last;
+};
+
+// Appends printf output to a string, growing it only when the message is longer than any before
+template<class... Args>
+void appendf(std::string& out, const char* format, Args... args) {
+	char field[64];
+	const int n = std::snprintf(field, sizeof(field), format, args...);
+	if (n > 0) out.append(field, static_cast<size_t>(n) < sizeof(field) ? n : sizeof(field) - 1);
+}
+
+}
+
+/**
+ * Encodes a client command as a CMD message.
+ * @param cmd The command to encode.
+ * @return The message text.
+ */
+std::string Protocol::encodeCommand(const ClientCommand& cmd) {
+	std::string out;
+	encodeCommand(cmd, out);
+	return out;
+}
+
+/**
+ * Encodes a client command into a reused buffer, numbers are written as an ostream would.
+ * @param cmd The command to encode.
+ * @param out Replaced with the message text.
+ */
+void Protocol::encodeCommand(const ClientCommand& cmd, std::string& out) {
+	// Two appends of at most 63 characters each, so a reused buffer reserved once never grows
+	out.clear();
+	out.reserve(128);
+	appendf(out, "CMD %d %d %u ", cmd.clientId, cmd.tick, cmd.actions);
+	appendf(out, "%g %g %d %d", cmd.x, cmd.y, cmd.room, cmd.seenTick);
+}
+
+/**
+ * Decodes a CMD message.
+ * @param data The message bytes.
+ * @param size The number of bytes.
+ * @param outCmd Receives the decoded command.
+ * @return true if the message was a well formed command, false otherwise.
+ */
+bool Protocol::decodeCommand(const char* data, size_t size, ClientCommand& outCmd) {
+	FieldReader in(data, size);
+	if (!in.tag("CMD")) return false;
+
+	ClientCommand cmd{};
+	if (!(in.read(cmd.clientId) && in.read(cmd.tick) && in.read(cmd.actions) && in.read(cmd.x) && in.read(cmd.y))) return false;
+	if (!in.done() && !in.read(cmd.room)) return false; // logs from before rooms have no room field
+	if (!in.done() && !in.read(cmd.seenTick)) return false; // or seen tick
+	outCmd = cmd;
+	return true;
+}
+
+/**
+ * Encodes a world snapshot as a SNAP message.
+ * @param snapshot The snapshot to encode, players are written in the order given.
+ * @return The message text.
+ */
+std::string Protocol::encodeSnapshot(const WorldSnapshot& snapshot) {
+	std::string out;
+	encodeSnapshot(snapshot, out);
+	return out;
+}
+
+/**
+ * Encodes a world snapshot into a reused buffer.
+ * @param snapshot The snapshot to encode, players are written in the order given.
+ * @param out Replaced with the message text.
+ */
+void Protocol::encodeSnapshot(const WorldSnapshot& snapshot, std::string& out) {
+	out.clear();
+	if (snapshot.partial) {
+		encodePartial(snapshot, out);
+		return;
+	}
+	appendf(out, "SNAP %d ", snapshot.tick);
+
+	// Output counts
+	appendf(out, "%zu %zu ", snapshot.playerIds.size(), snapshot.syncedObjects.size());
+
+	// Output players
+	for (size_t i = 0; i < snapshot.playerIds.size(); ++i) {
+		appendf(out, "%d %g %g ", snapshot.playerIds[i], snapshot.playerPositions[i].x, snapshot.playerPositions[i].y);
+	}
+
+	// Output synchronized objects
+	for (const SyncedObjectData& obj : snapshot.syncedObjects) {
+		appendf(out, "%d %d %g %g ", obj.id, obj.type, obj.position.x, obj.position.y);
+	}
+
+	// Output hit counts, left off when there are none so the message stays as it was
+	if (snapshot.playerHits.size() == snapshot.playerIds.size() &&
+		std::any_of(snapshot.playerHits.begin(), snapshot.playerHits.end(), [](int hits) { return hits != 0; })) {
+		for (int hits : snapshot.playerHits) appendf(out, "%d ", hits);
+	}
+}
+
+/**
+ * Encodes a partial snapshot as a PSNAP message, each player's hits are inline.
+ * @param snapshot The snapshot, with the roster filled in.
+ * @param out Appended to.
+ */
+void Protocol::encodePartial(const WorldSnapshot& snapshot, std::string& out) {
+	appendf(out, "PSNAP %d %zu %zu %zu ", snapshot.tick, snapshot.playerIds.size(), snapshot.syncedObjects.size(),
+		snapshot.roster.size());
+	for (size_t i = 0; i < snapshot.playerIds.size(); ++i) {
+		const int hits = i < snapshot.playerHits.size() ? snapshot.playerHits[i] : 0;
+		appendf(out, "%d %g %g %d ", snapshot.playerIds[i], snapshot.playerPositions[i].x, snapshot.playerPositions[i].y, hits);
+	}
+	for (const SyncedObjectData& obj : snapshot.syncedObjects) {
+		appendf(out, "%d %d %g %g ", obj.id, obj.type, obj.position.x, obj.position.y);
+	}
+	for (int id : snapshot.roster) {
+		appendf(out, "%d ", id);
+	}
+}
+
+/**
+ * Builds a room's topic. The '|' ends it, so room 1's subscription doesn't match room 12.
+ * @param room The room id.
+ * @return The topic frame text.
+ */
+std::string Protocol::roomTopic(int room) {
+	std::string out;
+	appendf(out, "ROOM %d|", room);
+	return out;
+}
+
+/**
+ * Builds a player's topic. It doesn't start with the room topic, so players subscribed to the
+ * room don't also get every other player's partial snapshots.
+ * @param room The room id.
+ * @param clientId The player.
+ * @return The topic frame text.
+ */
+std::string Protocol::playerTopic(int room, int clientId) {
+	std::string out;
+	appendf(out, "ROOM %d/%d|", room, clientId);
+	return out;
+}
+
+/**
+ * Decodes a SNAP or PSNAP message. The snapshot's vectors are resized in place, so decoding into the
+ * same snapshot every time only allocates when the world grows.
+ * @param data The message bytes.
+ * @param size The number of bytes.
+ * @param out Receives the decoded snapshot.
+ * @return true if the message was a well formed snapshot, false otherwise.
+ */
+bool Protocol::decodeSnapshot(const char* data, size_t size, WorldSnapshot& out) {
+	FieldReader in(data, size);
+
+	int tick, playerCount, objectCount, rosterCount = 0;
+	const bool partial = in.tag("PSNAP");
+	if (!partial && !in.tag("SNAP")) return false;
+	if (!(in.read(tick) && in.read(playerCount) && in.read(objectCount))) return false;
+	if (partial && !in.read(rosterCount)) return false;
+	if (playerCount < 0 || objectCount < 0 || rosterCount < 0) return false;
+
+	// Every field left takes a separator and at least one character, so counts the message
+	// can't hold are rejected before anything is sized to them
+	const uint64_t fields = static_cast<uint64_t>(playerCount) * (partial ? 4 : 3) +
+		static_cast<uint64_t>(objectCount) * 4 + static_cast<uint64_t>(rosterCount);
+	if (fields > in.remaining() / 2) return false;
+
+	out.tick = tick;
+	out.partial = partial;
+	out.playerIds.resize(playerCount);
+	out.playerPositions.resize(playerCount);
+	out.playerHits.assign(playerCount, 0);
+	out.syncedObjects.resize(objectCount);
+	out.roster.resize(rosterCount);
+
+	for (int i = 0; i < playerCount; ++i) {
+		int id; float x, y;
+		if (!(in.read(id) && in.read(x) && in.read(y))) return false;
+		if (partial && !in.read(out.playerHits[i])) return false;
+		out.playerIds[i] = id;
+		out.playerPositions[i] = { x, y };
+	}
+
+	// Read synchronized objects (id, type, x, y)
+	for (int j = 0; j < objectCount; ++j) {
+		int id, type; float x, y;
+		if (!(in.read(id) && in.read(type) && in.read(x) && in.read(y))) return false;
+		out.syncedObjects[j] = { id, type, {x, y} };
+	}
+
+	if (partial) {
+		for (int i = 0; i < rosterCount; ++i) {
+			if (!in.read(out.roster[i])) return false;
+		}
+		return true;
+	}
+
+	// Hit counts, only sent once someone has been hit
+	if (!in.done()) {
+		for (int i = 0; i < playerCount; ++i) {
+			if (!in.read(out.playerHits[i])) return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Encodes server stats as a STATS message.
+ * @param stats The stats to encode.
+ * @param out Replaced with the message text.
+ */
+void Protocol::encodeStats(const ServerStats& stats, std::string& out) {
+	out.clear();
+	appendf(out, "STATS %d %d %d ", stats.tick, stats.rooms, stats.clients);
+	appendf(out, "%g %g %g %g %u ", stats.tickP50Ms, stats.tickP95Ms, stats.tickP99Ms, stats.tickMaxMs, stats.overruns);
+	appendf(out, "%g %g ", stats.commandsPerSec, stats.snapshotBytesPerSec);
+	appendf(out, "%g %g %g %g", stats.roomsLockAvgUs, stats.roomsLockMaxUs, stats.objectsLockAvgUs, stats.objectsLockMaxUs);
+}
+
+/**
+ * Decodes a STATS message.
+ * @param data The message bytes.
+ * @param size The number of bytes.
+ * @param outStats Receives the decoded stats.
+ * @return true if the message was well formed stats, false otherwise.
+ */
+bool Protocol::decodeStats(const char* data, size_t size, ServerStats& outStats) {
+	FieldReader in(data, size);
+	if (!in.tag("STATS")) return false;
+
+	ServerStats stats;
+	if (!(in.read(stats.tick) && in.read(stats.rooms) && in.read(stats.clients) &&
+		in.read(stats.tickP50Ms) && in.read(stats.tickP95Ms) && in.read(stats.tickP99Ms) && in.read(stats.tickMaxMs) &&
+		in.read(stats.overruns) && in.read(stats.commandsPerSec) && in.read(stats.snapshotBytesPerSec) &&
+		in.read(stats.roomsLockAvgUs) && in.read(stats.roomsLockMaxUs) &&
+		in.read(stats.objectsLockAvgUs) && in.read(stats.objectsLockMaxUs))) return false;
+	outStats = stats;
+	return true;
+}
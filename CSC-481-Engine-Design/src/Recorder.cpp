@@ -0,0 +1,189 @@
+#include <engine/Recorder.h>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+	// File header written once at the start of a log
+	struct FileHeader {
+		char magic[8];
+		uint32_t version;
+		uint32_t reserved;
+	};
+
+	// Header in front of every record
+	struct RecordHeader {
+		uint32_t type;
+		int32_t tick;
+		uint64_t timeNS;
+		uint32_t size;
+		uint32_t reserved;
+	};
+
+	constexpr char kMagic[8] = { 'C', 'S', 'C', 'R', 'E', 'C', '1', '\0' };
+	constexpr uint32_t kVersion = 1;
+
+	// Records are padded so every header starts on an 8 byte boundary in the mapping
+	constexpr size_t padded(size_t size) {
+		return (size + 7) & ~static_cast<size_t>(7);
+	}
+
+	uint64_t nowNS() {
+		using namespace std::chrono;
+		return static_cast<uint64_t>(duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count());
+	}
+}
+
+Recorder::~Recorder() {
+	close();
+}
+
+/**
+ * Opens a session log, replacing any log already at the path. A session's ticks restart from
+ * zero, so appending a second session would make the replay jump back in time.
+ * @param path The log file.
+ * @return true if the log is ready for records, false otherwise.
+ */
+bool Recorder::open(const std::string& path) {
+	std::lock_guard<std::mutex> lock(fileMutex);
+	if (file) {
+		std::fclose(file);
+		file = nullptr;
+	}
+
+	file = std::fopen(path.c_str(), "wb");
+	if (!file) {
+		std::cerr << "[Recorder] Couldn't open " << path << " for writing\n";
+		return false;
+	}
+
+	FileHeader header{};
+	std::memcpy(header.magic, kMagic, sizeof(kMagic));
+	header.version = kVersion;
+	std::fwrite(&header, sizeof(header), 1, file);
+
+	startNS = nowNS();
+	return true;
+}
+
+// Flush and close the log
+void Recorder::close() {
+	std::lock_guard<std::mutex> lock(fileMutex);
+	if (file) {
+		std::fclose(file);
+		file = nullptr;
+	}
+}
+
+bool Recorder::isOpen() const {
+	std::lock_guard<std::mutex> lock(fileMutex);
+	return file != nullptr;
+}
+
+/**
+ * Appends one message to the log.
+ * @param type What kind of message this is.
+ * @param tick The tick the message belongs to.
+ * @param data The message bytes.
+ * @param size The number of bytes.
+ */
+void Recorder::record(RecordType type, int tick, const void* data, size_t size) {
+	static const char zeros[8] = {};
+
+	RecordHeader header{};
+	header.type = static_cast<uint32_t>(type);
+	header.tick = tick;
+	header.size = static_cast<uint32_t>(size);
+
+	std::lock_guard<std::mutex> lock(fileMutex);
+	if (!file) return;
+	header.timeNS = nowNS() - startNS;
+
+	std::fwrite(&header, sizeof(header), 1, file);
+	std::fwrite(data, 1, size, file);
+	std::fwrite(zeros, 1, padded(size) - size, file);
+}
+
+void Recorder::record(RecordType type, int tick, const std::string& message) {
+	record(type, tick, message.data(), message.size());
+}
+
+void Recorder::flush() {
+	std::lock_guard<std::mutex> lock(fileMutex);
+	if (file) std::fflush(file);
+}
+
+/**
+ * Maps a session log for replay and checks its header.
+ * @param path The log file.
+ * @return true if the log is mapped and valid, false otherwise.
+ */
+bool Replay::open(const std::string& path) {
+	cursor = 0;
+	if (!file.open(path)) {
+		std::cerr << "[Replay] Couldn't map " << path << "\n";
+		return false;
+	}
+
+	FileHeader header{};
+	if (file.size() < sizeof(header)) {
+		std::cerr << "[Replay] " << path << " is too small to be a session log\n";
+		file.close();
+		return false;
+	}
+	std::memcpy(&header, file.data(), sizeof(header));
+	if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion) {
+		std::cerr << "[Replay] " << path << " is not a session log\n";
+		file.close();
+		return false;
+	}
+
+	cursor = sizeof(FileHeader);
+	return true;
+}
+
+void Replay::close() {
+	file.close();
+	cursor = 0;
+}
+
+bool Replay::isOpen() const {
+	return file.isOpen();
+}
+
+/**
+ * Reads the next record from the mapping without copying its payload.
+ * @param out Receives the record.
+ * @return true if a complete record was read, false at the end of the log.
+ */
+bool Replay::next(ReplayRecord& out) {
+	if (!file.isOpen()) return false;
+
+	const size_t end = file.size();
+	if (cursor + sizeof(RecordHeader) > end) return false;
+
+	RecordHeader header;
+	std::memcpy(&header, file.data() + cursor, sizeof(header));
+	const size_t payload = cursor + sizeof(RecordHeader);
+	if (payload + header.size > end) return false; // cut short while recording
+
+	out.type = static_cast<RecordType>(header.type);
+	out.tick = header.tick;
+	out.timeNS = header.timeNS;
+	out.data = file.data() + payload;
+	out.size = header.size;
+
+	cursor = payload + padded(header.size);
+	return true;
+}
+
+bool Replay::next(RecordType type, ReplayRecord& out) {
+	while (next(out)) {
+		if (out.type == type) return true;
+	}
+	return false;
+}
+
+void Replay::rewind() {
+	cursor = file.isOpen() ? sizeof(FileHeader) : 0;
+}
@@ -0,0 +1,41 @@
+#include <engine/RenderQueue.h>
+#include <utility>
+
+RenderFrame& RenderQueue::beginFrame() {
+	RenderFrame& frame = frames[backIndex];
+	frame.commands.clear(); // keeps its capacity, so steady state extraction doesn't allocate
+	frame.removalStamp = 0;
+	return frame;
+}
+
+// Swaps the filled back frame into the ready slot, a frame the renderer skipped is reused
+void RenderQueue::publish() {
+	std::lock_guard<std::mutex> lock(mutex);
+	std::swap(backIndex, readyIndex);
+	fresh = true;
+}
+
+/**
+ * Takes the newest frame for drawing. Frames published since the last call replace the
+ * current one, otherwise the current one is drawn again.
+ * @return The frame to draw, or null if nothing was published yet.
+ */
+const RenderFrame* RenderQueue::acquire() {
+	std::lock_guard<std::mutex> lock(mutex);
+	if (fresh) {
+		std::swap(frontIndex, readyIndex);
+		fresh = false;
+		started = true;
+	}
+	return started ? &frames[frontIndex] : nullptr;
+}
+
+void RenderQueue::clear() {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (RenderFrame& frame : frames) {
+		frame.commands.clear();
+		frame.removalStamp = 0;
+	}
+	fresh = false;
+	started = false;
+}
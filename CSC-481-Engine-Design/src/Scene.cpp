@@ -0,0 +1,125 @@
+#include <engine/Scene.h>
+#include <cstring>
+#include <iostream>
+
+static_assert(sizeof(SceneHeader) == 64, "SceneHeader is part of the file format");
+static_assert(sizeof(SceneEntity) == 28, "SceneEntity is part of the file format");
+static_assert(sizeof(SceneObject) == 40, "SceneObject is part of the file format");
+
+// True if count records of size bytes starting at offset fit in a file of length bytes
+static bool fits(uint64_t offset, uint64_t count, uint64_t size, uint64_t length) {
+	return offset <= length && count <= (length - offset) / size;
+}
+
+/**
+ * Maps a scene file and checks that every section lies inside it.
+ * @param path The .scene file written by scene_convert.
+ * @return true if the file was mapped and is a valid scene, false otherwise.
+ */
+bool Scene::open(const std::string& path) {
+	close();
+	if (!file.open(path)) {
+		std::cerr << "Scene: could not map " << path << std::endl;
+		return false;
+	}
+
+	const SceneHeader* h = reinterpret_cast<const SceneHeader*>(file.data());
+	const uint64_t length = file.size();
+	if (length < sizeof(SceneHeader) || std::memcmp(h->magic, "CSCSCEN", 8) != 0 || h->version != kVersion ||
+		!fits(h->texturesOffset, h->textureCount, sizeof(uint32_t), length) ||
+		!fits(h->entitiesOffset, h->entityCount, sizeof(SceneEntity), length) ||
+		!fits(h->objectsOffset, h->objectCount, sizeof(SceneObject), length) ||
+		!fits(h->stringsOffset, h->stringsSize, 1, length) ||
+		(h->stringsSize > 0 && file.data()[h->stringsOffset + h->stringsSize - 1] != '\0')) {
+		std::cerr << "Scene: " << path << " is not a valid scene file" << std::endl;
+		file.close();
+		return false;
+	}
+
+	header = h;
+	textureTable = reinterpret_cast<const uint32_t*>(file.data() + h->texturesOffset);
+	entityRecords = reinterpret_cast<const SceneEntity*>(file.data() + h->entitiesOffset);
+	objectRecords = reinterpret_cast<const SceneObject*>(file.data() + h->objectsOffset);
+	strings = file.data() + h->stringsOffset;
+	return true;
+}
+
+void Scene::close() {
+	header = nullptr;
+	textureTable = nullptr;
+	entityRecords = nullptr;
+	objectRecords = nullptr;
+	strings = nullptr;
+	file.close();
+}
+
+bool Scene::isOpen() const {
+	return header != nullptr;
+}
+
+void Scene::registerKind(const std::string& kind, Factory factory) {
+	kinds[kind] = std::move(factory);
+}
+
+/**
+ * Creates the scene's entities through the registered factories.
+ * Records of the same kind share a name offset, so each kind is looked up once.
+ * @return The number of records a factory was found for.
+ */
+size_t Scene::instantiate() const {
+	if (!header) return 0;
+
+	std::unordered_map<uint32_t, const Factory*> byOffset;
+	size_t created = 0;
+	for (uint32_t i = 0; i < header->entityCount; ++i) {
+		const SceneEntity& record = entityRecords[i];
+		auto cached = byOffset.find(record.kind);
+		if (cached == byOffset.end()) {
+			const char* name = string(record.kind);
+			auto it = name ? kinds.find(name) : kinds.end();
+			if (it == kinds.end()) {
+				std::cerr << "Scene: no factory for kind " << (name ? name : "?") << std::endl;
+			}
+			cached = byOffset.emplace(record.kind, it == kinds.end() ? nullptr : &it->second).first;
+		}
+		if (!cached->second) continue;
+
+		(*cached->second)(record, texture(record.texture));
+		++created;
+	}
+	return created;
+}
+
+const SceneEntity* Scene::entities() const {
+	return entityRecords;
+}
+
+uint32_t Scene::entityCount() const {
+	return header ? header->entityCount : 0;
+}
+
+const SceneObject* Scene::objects() const {
+	return objectRecords;
+}
+
+uint32_t Scene::objectCount() const {
+	return header ? header->objectCount : 0;
+}
+
+const char* Scene::texture(uint32_t index) const {
+	if (!header || index >= header->textureCount) return nullptr;
+	return string(textureTable[index]);
+}
+
+const char* Scene::kindOf(const SceneEntity& record) const {
+	return string(record.kind);
+}
+
+const char* Scene::tilemap() const {
+	return header ? string(header->tilemap) : nullptr;
+}
+
+const char* Scene::string(uint32_t offset) const {
+	if (!header || offset >= header->stringsSize) return nullptr;
+	return strings + offset;
+}
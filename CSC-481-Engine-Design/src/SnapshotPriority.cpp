@@ -0,0 +1,55 @@
+#include <engine/SnapshotPriority.h>
+#include <algorithm>
+#include <cmath>
+
+PriorityAccumulator::PriorityAccumulator(const PriorityWeights& weights) : weights(weights) {
+}
+
+// What a candidate adds to its priority for one tick
+float PriorityAccumulator::weightOf(OrderedPair viewer, const ReplicationCandidate& candidate) const {
+	const float dx = candidate.position.x - viewer.x;
+	const float dy = candidate.position.y - viewer.y;
+	const float distance = std::sqrt(dx * dx + dy * dy);
+	const float speed = std::sqrt(candidate.velocity.x * candidate.velocity.x + candidate.velocity.y * candidate.velocity.y);
+	return weights.base +
+		weights.nearby / (1.0f + distance / weights.falloff) +
+		weights.motion * speed / weights.speedScale;
+}
+
+void PriorityAccumulator::select(OrderedPair viewer, const std::vector<ReplicationCandidate>& candidates,
+	size_t budgetBytes, std::vector<int>& picked) {
+	++selections;
+	picked.clear();
+	order.clear();
+
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		Entry& entry = entries[candidates[i].key];
+		entry.priority += weightOf(viewer, candidates[i]);
+		entry.selection = selections;
+		order.push_back({ entry.priority, static_cast<int>(i) });
+	}
+
+	// Most important first, anything that still fits goes in after one that doesn't
+	std::sort(order.begin(), order.end(),
+		[](const std::pair<float, int>& a, const std::pair<float, int>& b) { return a.first > b.first; });
+	size_t used = 0;
+	for (const auto& [priority, index] : order) {
+		const ReplicationCandidate& candidate = candidates[index];
+		if (used + candidate.bytes > budgetBytes) continue;
+		used += candidate.bytes;
+		entries[candidate.key].priority = 0.0f;
+		picked.push_back(index);
+	}
+
+	// Entities that are gone
+	if (entries.size() > candidates.size()) {
+		for (auto it = entries.begin(); it != entries.end();) {
+			if (it->second.selection != selections) it = entries.erase(it);
+			else ++it;
+		}
+	}
+}
+
+void PriorityAccumulator::clear() {
+	entries.clear();
+}
@@ -0,0 +1,62 @@
+#include <engine/Telemetry.h>
+#include <algorithm>
+
+void LockWaitStats::record(uint64_t waitNS) {
+	count.fetch_add(1, std::memory_order_relaxed);
+	totalNS.fetch_add(waitNS, std::memory_order_relaxed);
+	uint64_t longest = maxNS.load(std::memory_order_relaxed);
+	while (waitNS > longest && !maxNS.compare_exchange_weak(longest, waitNS, std::memory_order_relaxed)) {}
+}
+
+void LockWaitStats::take(float& avgUs, float& maxUs) {
+	const uint64_t n = count.exchange(0, std::memory_order_relaxed);
+	const uint64_t total = totalNS.exchange(0, std::memory_order_relaxed);
+	const uint64_t longest = maxNS.exchange(0, std::memory_order_relaxed);
+	avgUs = n > 0 ? static_cast<float>(total / n) / 1000.0f : 0.0f;
+	maxUs = static_cast<float>(longest) / 1000.0f;
+}
+
+/**
+ * Creates tick stats for a loop.
+ * @param budgetNS The tick period in nanoseconds.
+ * @param ticksPerWindow Ticks expected between resets, space for them is reserved now.
+ */
+TickStats::TickStats(uint64_t budgetNS, size_t ticksPerWindow) : budgetNS(budgetNS) {
+	samples.reserve(ticksPerWindow * 2); // slack for a window that runs long
+}
+
+void TickStats::record(uint64_t durationNS) {
+	if (samples.size() < samples.capacity()) samples.push_back(durationNS);
+	longestNS = std::max(longestNS, durationNS);
+	if (durationNS > budgetNS) ++overrunCount;
+}
+
+/**
+ * Finds a percentile by partially sorting the window, which reorders the samples.
+ * @param p The percentile as a fraction, e.g. 0.99.
+ * @return The duration in milliseconds.
+ */
+float TickStats::percentileMs(float p) {
+	if (samples.empty()) return 0.0f;
+	const size_t rank = std::min(samples.size() - 1, static_cast<size_t>(p * samples.size()));
+	std::nth_element(samples.begin(), samples.begin() + rank, samples.end());
+	return samples[rank] / 1e6f;
+}
+
+float TickStats::maxMs() const {
+	return longestNS / 1e6f;
+}
+
+uint32_t TickStats::overruns() const {
+	return overrunCount;
+}
+
+size_t TickStats::count() const {
+	return samples.size();
+}
+
+void TickStats::reset() {
+	samples.clear();
+	longestNS = 0;
+	overrunCount = 0;
+}
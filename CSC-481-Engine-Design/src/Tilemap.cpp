@@ -0,0 +1,405 @@
+#include <engine/Tilemap.h>
+#include <engine/Assets.h>
+#include <engine/Allocations.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+Tilemap::~Tilemap() {
+	close();
+}
+
+/**
+ * Maps a level file and starts streaming. Nothing is loaded until setFocus is called.
+ * @param path The .tmap file written by tilemap_build.
+ * @return true if the file was mapped and its header is valid, false otherwise.
+ */
+bool Tilemap::open(const std::string& path) {
+	close();
+	if (!file.open(path)) {
+		std::cerr << "Tilemap: could not map " << path << std::endl;
+		return false;
+	}
+
+	// Validate the header and chunk table before trusting any offset
+	if (file.size() < sizeof(TilemapHeader)) {
+		std::cerr << "Tilemap: " << path << " is too small" << std::endl;
+		file.close();
+		return false;
+	}
+	const TilemapHeader* h = reinterpret_cast<const TilemapHeader*>(file.data());
+	const size_t chunkCount = static_cast<size_t>(h->chunksX) * h->chunksY;
+	if (std::memcmp(h->magic, "CSCTMAP", 8) != 0 || h->version != kVersion || h->chunkSize == 0 ||
+		h->tileSize == 0 || chunkCount == 0 || h->tileset[sizeof(h->tileset) - 1] != '\0' ||
+		file.size() < sizeof(TilemapHeader) + chunkCount * sizeof(uint64_t)) {
+		std::cerr << "Tilemap: " << path << " is not a valid level file" << std::endl;
+		file.close();
+		return false;
+	}
+
+	header = h;
+	offsets = reinterpret_cast<const uint64_t*>(file.data() + sizeof(TilemapHeader));
+	tileSize = static_cast<float>(h->tileSize);
+	chunkWorld = tileSize * h->chunkSize;
+	resident.resize(chunkCount);
+	requested.assign(chunkCount, 0);
+	stopLoader = false;
+	focusChanged = false;
+	loader = std::thread(&Tilemap::loaderLoop, this);
+	return true;
+}
+
+/**
+ * Stops the loader thread, frees every chunk and its texture, and unmaps the file.
+ */
+void Tilemap::close() {
+	if (loader.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(loaderMutex);
+			stopLoader = true;
+		}
+		loaderCV.notify_all();
+		loader.join();
+	}
+	{
+		std::unique_lock<std::shared_mutex> lock(residentMutex);
+		for (std::unique_ptr<Chunk>& chunk : resident) {
+			if (chunk) destroyChunk(*chunk);
+		}
+		resident.clear();
+	}
+	finished.clear();
+	requested.clear();
+	focusRange = { 0, 0, -1, -1 };
+	Assets::releaseTexture(tileset);
+	tileset = nullptr;
+	tilesetTried = false;
+	header = nullptr;
+	offsets = nullptr;
+	file.close();
+}
+
+bool Tilemap::isOpen() const {
+	return header != nullptr;
+}
+
+/**
+ * Moves the streaming focus and wakes the loader.
+ * @param area World area that should have its chunks loaded.
+ */
+void Tilemap::setFocus(const SDL_FRect& area) {
+	if (!header) return;
+	{
+		std::lock_guard<std::mutex> lock(loaderMutex);
+		focus = area;
+		// Only wake the loader when the wanted chunks change, not on every small move
+		const ChunkRange wanted = rangeFor(area, margin);
+		if (wanted.x0 == focusRange.x0 && wanted.y0 == focusRange.y0 &&
+			wanted.x1 == focusRange.x1 && wanted.y1 == focusRange.y1) {
+			return;
+		}
+		focusRange = wanted;
+		focusChanged = true;
+	}
+	loaderCV.notify_one();
+}
+
+void Tilemap::setLoadMargin(int chunks) {
+	{
+		std::lock_guard<std::mutex> lock(loaderMutex);
+		margin = std::max(0, chunks);
+		focusRange = { 0, 0, -1, -1 };
+		focusChanged = header != nullptr;
+	}
+	loaderCV.notify_one();
+}
+
+/**
+ * Gets the chunks covering an area grown by a margin, clamped to the level.
+ * @param area World area.
+ * @param margin Extra chunks on every side.
+ * @return Inclusive chunk coordinate range, empty (x0 > x1) if the area is off the level.
+ */
+Tilemap::ChunkRange Tilemap::rangeFor(const SDL_FRect& area, int margin) const {
+	ChunkRange r;
+	r.x0 = static_cast<int>(std::floor(area.x / chunkWorld)) - margin;
+	r.y0 = static_cast<int>(std::floor(area.y / chunkWorld)) - margin;
+	r.x1 = static_cast<int>(std::floor((area.x + area.w) / chunkWorld)) + margin;
+	r.y1 = static_cast<int>(std::floor((area.y + area.h) / chunkWorld)) + margin;
+	r.x0 = std::max(r.x0, 0);
+	r.y0 = std::max(r.y0, 0);
+	r.x1 = std::min(r.x1, static_cast<int>(header->chunksX) - 1);
+	r.y1 = std::min(r.y1, static_cast<int>(header->chunksY) - 1);
+	return r;
+}
+
+/**
+ * Loader thread: waits for the focus to move, then decodes every chunk around it that
+ * isn't loaded yet, nearest first. A new focus interrupts the batch so it's re-prioritized.
+ */
+void Tilemap::loaderLoop() {
+	AllocScope scope(AllocTag::Streaming);
+	std::unique_lock<std::mutex> lock(loaderMutex);
+	while (true) {
+		loaderCV.wait(lock, [this]() { return stopLoader || focusChanged; });
+		if (stopLoader) return;
+		focusChanged = false;
+
+		// Chunks to load, closest to the focus center first
+		const ChunkRange want = rangeFor(focus, margin);
+		const float centerX = (focus.x + focus.w * 0.5f) / chunkWorld - 0.5f;
+		const float centerY = (focus.y + focus.h * 0.5f) / chunkWorld - 0.5f;
+		std::vector<int> todo;
+		for (int cy = want.y0; cy <= want.y1; ++cy) {
+			for (int cx = want.x0; cx <= want.x1; ++cx) {
+				const int index = cy * static_cast<int>(header->chunksX) + cx;
+				if (requested[index]) continue;
+				requested[index] = 1;
+				todo.push_back(index);
+			}
+		}
+		const int chunksX = static_cast<int>(header->chunksX);
+		std::sort(todo.begin(), todo.end(), [&](int a, int b) {
+			const float ax = a % chunksX - centerX, ay = a / chunksX - centerY;
+			const float bx = b % chunksX - centerX, by = b / chunksX - centerY;
+			return ax * ax + ay * ay < bx * bx + by * by;
+		});
+
+		for (size_t i = 0; i < todo.size(); ++i) {
+			if (stopLoader) return;
+			if (focusChanged) {
+				// Focus moved on, hand the rest back so the next pass can re-rank them
+				for (size_t j = i; j < todo.size(); ++j) requested[todo[j]] = 0;
+				break;
+			}
+			// Decode without the lock so setFocus and update() never wait on disk
+			lock.unlock();
+			std::unique_ptr<Chunk> chunk = loadChunk(todo[i] % chunksX, todo[i] / chunksX);
+			lock.lock();
+			finished.push_back(std::move(chunk));
+		}
+	}
+}
+
+/**
+ * Reads one chunk from the mapping and merges its tiles into solid rects.
+ * Rows are first merged into horizontal runs, then runs with the same span in consecutive
+ * rows become one rect, so a platform or wall is a single collision box.
+ * @return The chunk, with no tiles if it is stored as empty or its data is out of range.
+ */
+std::unique_ptr<Tilemap::Chunk> Tilemap::loadChunk(int cx, int cy) const {
+	std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>();
+	chunk->cx = cx;
+	chunk->cy = cy;
+
+	const uint32_t n = header->chunkSize;
+	const uint64_t offset = offsets[cy * header->chunksX + cx];
+	const size_t bytes = static_cast<size_t>(n) * n * sizeof(uint16_t);
+	if (offset == 0 || offset + bytes > file.size()) return chunk;
+
+	chunk->tiles.resize(static_cast<size_t>(n) * n);
+	std::memcpy(chunk->tiles.data(), file.data() + offset, bytes);
+
+	const float originX = cx * chunkWorld;
+	const float originY = cy * chunkWorld;
+	std::vector<int> open, next; // solids still growing downward, by index
+	for (uint32_t ty = 0; ty < n; ++ty) {
+		next.clear();
+		uint32_t tx = 0;
+		while (tx < n) {
+			if (chunk->tiles[ty * n + tx] == 0) { ++tx; continue; }
+			const uint32_t start = tx;
+			while (tx < n && chunk->tiles[ty * n + tx] != 0) ++tx;
+
+			const float x = originX + start * tileSize;
+			const float w = (tx - start) * tileSize;
+			auto grow = std::find_if(open.begin(), open.end(), [&](int i) {
+				return chunk->solids[i].x == x && chunk->solids[i].w == w;
+			});
+			if (grow != open.end()) {
+				chunk->solids[*grow].h += tileSize;
+				next.push_back(*grow);
+			}
+			else {
+				chunk->solids.push_back({ x, originY + ty * tileSize, w, tileSize });
+				next.push_back(static_cast<int>(chunk->solids.size()) - 1);
+			}
+		}
+		open.swap(next);
+	}
+	return chunk;
+}
+
+/**
+ * Takes in chunks the loader finished and drops chunks that are past the margin plus one,
+ * so a focus going back and forth over a chunk edge doesn't reload it every time.
+ * Main thread only, since dropping a chunk destroys its texture.
+ */
+void Tilemap::update() {
+	if (!header) return;
+
+	std::vector<std::unique_ptr<Chunk>> incoming;
+	SDL_FRect area;
+	int keepMargin;
+	{
+		std::lock_guard<std::mutex> lock(loaderMutex);
+		incoming.swap(finished);
+		area = focus;
+		keepMargin = margin + 1;
+	}
+	const ChunkRange keep = rangeFor(area, keepMargin);
+
+	std::vector<int> dropped;
+	{
+		std::unique_lock<std::shared_mutex> lock(residentMutex);
+		for (std::unique_ptr<Chunk>& chunk : incoming) {
+			const int index = chunk->cy * static_cast<int>(header->chunksX) + chunk->cx;
+			if (keep.contains(chunk->cx, chunk->cy)) {
+				resident[index] = std::move(chunk);
+			}
+			else {
+				dropped.push_back(index); // focus left before it arrived
+			}
+		}
+		for (size_t index = 0; index < resident.size(); ++index) {
+			Chunk* chunk = resident[index].get();
+			if (!chunk || keep.contains(chunk->cx, chunk->cy)) continue;
+			destroyChunk(*chunk);
+			resident[index].reset();
+			dropped.push_back(static_cast<int>(index));
+		}
+	}
+	if (!dropped.empty()) {
+		std::lock_guard<std::mutex> lock(loaderMutex);
+		for (int index : dropped) requested[index] = 0;
+	}
+}
+
+/**
+ * Draws every loaded chunk in view, baking each chunk's tiles into one texture the first time.
+ * @param renderer The renderer to draw with.
+ * @param view World area shown on screen, its corner lands at the screen origin.
+ * @param zoom Screen pixels per world unit.
+ */
+void Tilemap::draw(SDL_Renderer* renderer, const SDL_FRect& view, float zoom) {
+	if (!header || !renderer) return;
+
+	const ChunkRange r = rangeFor(view, 0);
+	std::shared_lock<std::shared_mutex> lock(residentMutex);
+	for (int cy = r.y0; cy <= r.y1; ++cy) {
+		for (int cx = r.x0; cx <= r.x1; ++cx) {
+			Chunk* chunk = resident[cy * header->chunksX + cx].get();
+			if (!chunk || chunk->tiles.empty()) continue;
+			if (!chunk->texture) bake(renderer, *chunk);
+			if (!chunk->texture) continue;
+
+			SDL_FRect dst = { (cx * chunkWorld - view.x) * zoom, (cy * chunkWorld - view.y) * zoom,
+							  chunkWorld * zoom, chunkWorld * zoom };
+			SDL_RenderTexture(renderer, chunk->texture, nullptr, &dst);
+		}
+	}
+}
+
+// Renders a chunk's tiles into a texture once, so drawing it later is a single copy
+void Tilemap::bake(SDL_Renderer* renderer, Chunk& chunk) {
+	if (!tileset && !tilesetTried) {
+		tilesetTried = true;
+		tileset = Assets::acquireTexture(header->tileset);
+	}
+
+	const int side = static_cast<int>(chunkWorld);
+	chunk.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_TARGET, side, side);
+	if (!chunk.texture) return;
+	SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+
+	float cellW = 0.0f, cellH = 0.0f;
+	if (tileset) {
+		SDL_GetTextureSize(tileset, &cellW, &cellH);
+		cellW /= std::max(1u, header->tilesetColumns);
+		cellH /= std::max(1u, header->tilesetRows);
+	}
+
+	SDL_SetRenderTarget(renderer, chunk.texture);
+	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+	SDL_RenderClear(renderer);
+	const uint32_t n = header->chunkSize;
+	for (uint32_t ty = 0; ty < n; ++ty) {
+		for (uint32_t tx = 0; tx < n; ++tx) {
+			const uint16_t id = chunk.tiles[ty * n + tx];
+			if (id == 0) continue;
+			SDL_FRect dst = { tx * tileSize, ty * tileSize, tileSize, tileSize };
+			if (tileset) {
+				const uint32_t cell = id - 1u;
+				const uint32_t columns = std::max(1u, header->tilesetColumns);
+				SDL_FRect src = { (cell % columns) * cellW, (cell / columns) * cellH, cellW, cellH };
+				SDL_RenderTexture(renderer, tileset, &src, &dst);
+			}
+			else {
+				SDL_SetRenderDrawColor(renderer, 120, 72, 48, 255); // brick colored stand in
+				SDL_RenderFillRect(renderer, &dst);
+			}
+		}
+	}
+	SDL_SetRenderTarget(renderer, nullptr);
+}
+
+void Tilemap::destroyChunk(Chunk& chunk) {
+	if (chunk.texture) SDL_DestroyTexture(chunk.texture);
+	chunk.texture = nullptr;
+}
+
+/**
+ * Finds the solid rects of loaded chunks overlapping an area.
+ * Touching edges don't count, matching Collision::checkCollision.
+ * @param area The area to search.
+ * @param out Matching rects are appended here.
+ */
+void Tilemap::query(const SDL_FRect& area, std::vector<SDL_FRect>& out) const {
+	if (!header) return;
+	const ChunkRange r = rangeFor(area, 0);
+	std::shared_lock<std::shared_mutex> lock(residentMutex);
+	for (int cy = r.y0; cy <= r.y1; ++cy) {
+		for (int cx = r.x0; cx <= r.x1; ++cx) {
+			const Chunk* chunk = resident[cy * header->chunksX + cx].get();
+			if (!chunk) continue;
+			for (const SDL_FRect& s : chunk->solids) {
+				if (area.x < s.x + s.w && area.x + area.w > s.x && area.y < s.y + s.h && area.y + area.h > s.y) {
+					out.push_back(s);
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Looks up one tile.
+ * @return The tile id at a world point, 0 if empty, off the level or not loaded.
+ */
+uint16_t Tilemap::tileAt(float x, float y) const {
+	if (!header || x < 0.0f || y < 0.0f) return 0;
+	const int cx = static_cast<int>(x / chunkWorld);
+	const int cy = static_cast<int>(y / chunkWorld);
+	if (cx >= static_cast<int>(header->chunksX) || cy >= static_cast<int>(header->chunksY)) return 0;
+
+	std::shared_lock<std::shared_mutex> lock(residentMutex);
+	const Chunk* chunk = resident[cy * header->chunksX + cx].get();
+	if (!chunk || chunk->tiles.empty()) return 0;
+	const uint32_t tx = static_cast<uint32_t>((x - cx * chunkWorld) / tileSize);
+	const uint32_t ty = static_cast<uint32_t>((y - cy * chunkWorld) / tileSize);
+	return chunk->tiles[ty * header->chunkSize + tx];
+}
+
+SDL_FRect Tilemap::getBounds() const {
+	if (!header) return { 0.0f, 0.0f, 0.0f, 0.0f };
+	return { 0.0f, 0.0f, header->chunksX * chunkWorld, header->chunksY * chunkWorld };
+}
+
+float Tilemap::getTileSize() const {
+	return tileSize;
+}
+
+size_t Tilemap::residentChunks() const {
+	std::shared_lock<std::shared_mutex> lock(residentMutex);
+	return std::count_if(resident.begin(), resident.end(), [](const std::unique_ptr<Chunk>& c) { return c != nullptr; });
+}
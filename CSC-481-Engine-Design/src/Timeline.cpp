@@ -1,49 +1,100 @@
-#include "engine/Timeline.h"
-#include <algorithm>
-
-// Initialize the timeline by capturing the current ticks
-void Timeline::init() {
-    lastTicks = SDL_GetTicks();
-}
-
-// Update the timeline, returning the scaled delta time since last call
-double Timeline::update() {
-    if (paused) return 0.0;
-
-    Uint64 now = SDL_GetTicks();
-    double delta = (now - lastTicks) / 1000.0;
-    lastTicks = now;
-    accumulated += delta * timeScale;
-    return delta * timeScale;
-}
-
-// Clamp scale between halfSpeed and doubleSpeed
-void Timeline::setScale(double s) {
-    timeScale = std::clamp(s, halfSpeed, doubleSpeed);
-}
-
-// Get the current time scale
-double Timeline::getScale() const {
-    return timeScale;
-}
-
-// Pause the timeline
-void Timeline::pause() {
-    paused = true;
-}
-
-// Resume the timeline
-void Timeline::resume() {
-    paused = false;
-    lastTicks = SDL_GetTicks(); // avoid time jump on resume
-}
-
-// Check if the timeline is paused
-bool Timeline::isPaused() const {
-    return paused;
-}
-
-// Get the total accumulated game time (scaled)
-double Timeline::getAccumulatedTime() const {
-    return accumulated;
-}
+#include "engine/Timeline.h"
+#include <algorithm>
+
+/**
+ * Creates a timeline at local time 0.
+ * @param parent The timeline to follow, or nullptr to follow the real clock.
+ */
+Timeline::Timeline(Timeline* parent) : parent(parent) {
+    init();
+}
+
+// Initialize the timeline by anchoring local time 0 at the parent's current time
+void Timeline::init() {
+    const int64_t parentNow = parentTimeNS();
+    std::lock_guard<std::mutex> lock(mutex);
+    anchorLocal = 0;
+    anchorParent = parentNow;
+    lastUpdate = 0;
+}
+
+// Update the timeline, returning the scaled delta time since last call
+double Timeline::update() {
+    const int64_t now = getTimeNS();
+    std::lock_guard<std::mutex> lock(mutex);
+    const int64_t delta = now - lastUpdate;
+    lastUpdate = now;
+    return delta / 1e9;
+}
+
+/**
+ * Gets the current local time.
+ * @return Nanoseconds of scaled, unpaused time since init().
+ */
+int64_t Timeline::getTimeNS() const {
+    const int64_t parentNow = parentTimeNS();
+    std::lock_guard<std::mutex> lock(mutex);
+    return localAt(parentNow);
+}
+
+int64_t Timeline::parentTimeNS() const {
+    return parent ? parent->getTimeNS() : static_cast<int64_t>(SDL_GetTicksNS());
+}
+
+int64_t Timeline::localAt(int64_t parentNow) const {
+    if (paused) return anchorLocal;
+    return anchorLocal + static_cast<int64_t>((parentNow - anchorParent) * timeScale);
+}
+
+void Timeline::rebase(int64_t parentNow) {
+    anchorLocal = localAt(parentNow);
+    anchorParent = parentNow;
+}
+
+// Clamp scale between halfSpeed and doubleSpeed
+void Timeline::setScale(double s) {
+    const int64_t parentNow = parentTimeNS();
+    std::lock_guard<std::mutex> lock(mutex);
+    rebase(parentNow);
+    timeScale = std::clamp(s, halfSpeed, doubleSpeed);
+}
+
+// Get the current time scale
+double Timeline::getScale() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return timeScale;
+}
+
+// Pause the timeline
+void Timeline::pause() {
+    const int64_t parentNow = parentTimeNS();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (paused) return;
+    rebase(parentNow);
+    paused = true;
+}
+
+// Resume the timeline
+void Timeline::resume() {
+    const int64_t parentNow = parentTimeNS();
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!paused) return;
+    anchorParent = parentNow; // avoid time jump on resume
+    paused = false;
+}
+
+// Check if the timeline is paused
+bool Timeline::isPaused() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return paused;
+}
+
+// Get the total accumulated game time (scaled)
+double Timeline::getAccumulatedTime() const {
+    return getTimeNS() / 1e9;
+}
+
+// Get the timeline this one follows, null for a root
+Timeline* Timeline::getParent() const {
+    return parent;
+}
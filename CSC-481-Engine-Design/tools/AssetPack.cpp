@@ -0,0 +1,212 @@
+#include <engine/Assets.h>
+#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Builds an asset pack of pre-decoded textures and pre-rasterized fonts.
+//
+//   asset_pack <manifest.txt> <root dir> <out.pack>
+//
+// Manifest, one asset per line, '#' starts a comment, paths are relative to the root dir:
+//   texture assets/Brick.png                      stored under its path, as Entity loads it
+//   font hud assets/DejaVuSans.ttf 24             printable ASCII rasterized at 24 pt, stored as "hud"
+
+// Printable ASCII, the range every font atlas covers
+static const uint32_t kFirstGlyph = 32;
+static const uint32_t kLastGlyph = 126;
+static const int kAtlasWidth = 512;
+
+// One asset's entry and its data, before offsets are assigned
+struct PackedAsset {
+    AssetPackEntry entry{};
+    std::vector<uint8_t> pixels;
+    std::vector<AssetGlyph> glyphs;
+};
+
+// Copies a surface into tightly packed RGBA32 rows
+static bool readPixels(SDL_Surface* surface, std::vector<uint8_t>& out, int& w, int& h) {
+    SDL_Surface* rgba = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGBA32);
+    if (!rgba) return false;
+    w = rgba->w;
+    h = rgba->h;
+    out.resize(static_cast<size_t>(w) * h * 4);
+    for (int y = 0; y < h; ++y) {
+        std::memcpy(out.data() + static_cast<size_t>(y) * w * 4,
+            static_cast<const uint8_t*>(rgba->pixels) + static_cast<size_t>(y) * rgba->pitch, static_cast<size_t>(w) * 4);
+    }
+    SDL_DestroySurface(rgba);
+    return true;
+}
+
+static bool packTexture(const std::string& root, const std::string& path, PackedAsset& asset) {
+    SDL_Surface* surface = IMG_Load((root + "/" + path).c_str());
+    if (!surface) {
+        std::cerr << "[asset_pack] Could not decode " << path << ": " << SDL_GetError() << "\n";
+        return false;
+    }
+    int w = 0, h = 0;
+    const bool ok = readPixels(surface, asset.pixels, w, h);
+    SDL_DestroySurface(surface);
+    if (!ok) return false;
+
+    asset.entry.type = AssetPackEntry::Texture;
+    asset.entry.width = static_cast<uint32_t>(w);
+    asset.entry.height = static_cast<uint32_t>(h);
+    return true;
+}
+
+// Rasterizes printable ASCII into one atlas, packing glyphs left to right in rows
+static bool packFont(const std::string& root, const std::string& path, float size, PackedAsset& asset) {
+    TTF_Font* font = TTF_OpenFont((root + "/" + path).c_str(), size);
+    if (!font) {
+        std::cerr << "[asset_pack] Could not open font " << path << ": " << SDL_GetError() << "\n";
+        return false;
+    }
+
+    struct Rendered { std::vector<uint8_t> pixels; int w = 0, h = 0; };
+    std::vector<Rendered> rendered(kLastGlyph - kFirstGlyph + 1);
+    asset.glyphs.resize(rendered.size());
+
+    const SDL_Color white = { 255, 255, 255, 255 };
+    int penX = 0, penY = 0, rowHeight = 0;
+    for (uint32_t cp = kFirstGlyph; cp <= kLastGlyph; ++cp) {
+        Rendered& r = rendered[cp - kFirstGlyph];
+        AssetGlyph& g = asset.glyphs[cp - kFirstGlyph];
+        int minX, maxX, minY, maxY, advance = 0;
+        TTF_GetGlyphMetrics(font, cp, &minX, &maxX, &minY, &maxY, &advance);
+        g.advance = static_cast<int16_t>(advance);
+
+        SDL_Surface* surface = TTF_RenderGlyph_Blended(font, cp, white);
+        if (!surface) continue; // nothing to draw, e.g. space
+        readPixels(surface, r.pixels, r.w, r.h);
+        SDL_DestroySurface(surface);
+
+        if (penX + r.w > kAtlasWidth) {
+            penX = 0;
+            penY += rowHeight + 1;
+            rowHeight = 0;
+        }
+        g.x = static_cast<uint16_t>(penX);
+        g.y = static_cast<uint16_t>(penY);
+        g.w = static_cast<uint16_t>(r.w);
+        g.h = static_cast<uint16_t>(r.h);
+        penX += r.w + 1; // a pixel gap so filtering never bleeds between glyphs
+        rowHeight = std::max(rowHeight, r.h);
+    }
+    const int atlasHeight = std::max(1, penY + rowHeight);
+
+    asset.pixels.assign(static_cast<size_t>(kAtlasWidth) * atlasHeight * 4, 0);
+    for (size_t i = 0; i < rendered.size(); ++i) {
+        const Rendered& r = rendered[i];
+        const AssetGlyph& g = asset.glyphs[i];
+        for (int y = 0; y < r.h; ++y) {
+            std::memcpy(asset.pixels.data() + (static_cast<size_t>(g.y + y) * kAtlasWidth + g.x) * 4,
+                r.pixels.data() + static_cast<size_t>(y) * r.w * 4, static_cast<size_t>(r.w) * 4);
+        }
+    }
+
+    asset.entry.type = AssetPackEntry::Font;
+    asset.entry.width = kAtlasWidth;
+    asset.entry.height = static_cast<uint32_t>(atlasHeight);
+    asset.entry.firstGlyph = kFirstGlyph;
+    asset.entry.glyphCount = static_cast<uint32_t>(asset.glyphs.size());
+    asset.entry.lineHeight = TTF_GetFontHeight(font);
+    TTF_CloseFont(font);
+    return true;
+}
+
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 4) {
+        std::cerr << "usage: asset_pack <manifest.txt> <root dir> <out.pack>\n";
+        return 1;
+    }
+    const std::string root = argv[2];
+
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "[asset_pack] Could not open " << argv[1] << "\n";
+        return 1;
+    }
+    if (!TTF_Init()) {
+        std::cerr << "[asset_pack] Could not init SDL_ttf: " << SDL_GetError() << "\n";
+        return 1;
+    }
+
+    std::vector<PackedAsset> assets;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string key, name, path;
+        if (!(words >> key)) continue;
+
+        PackedAsset asset;
+        bool ok = false;
+        if (key == "texture" && words >> path) {
+            name = path;
+            ok = packTexture(root, path, asset);
+        }
+        else if (key == "font") {
+            float size = 0.0f;
+            ok = static_cast<bool>(words >> name >> path >> size) && packFont(root, path, size, asset);
+        }
+        else {
+            std::cerr << "[asset_pack] Line " << lineNumber << " is not valid: " << line << "\n";
+        }
+        if (ok && name.size() >= sizeof(asset.entry.name)) {
+            std::cerr << "[asset_pack] Line " << lineNumber << ": name too long\n";
+            ok = false;
+        }
+        if (!ok) {
+            TTF_Quit();
+            return 1;
+        }
+        std::strncpy(asset.entry.name, name.c_str(), sizeof(asset.entry.name) - 1);
+        assets.push_back(std::move(asset));
+    }
+    TTF_Quit();
+
+    // Header, entry table, then each asset's pixels and glyphs on 8 byte boundaries
+    AssetPackHeader header{};
+    std::memcpy(header.magic, "CSCPACK", 8);
+    header.version = Assets::kPackVersion;
+    header.entryCount = static_cast<uint32_t>(assets.size());
+    header.entriesOffset = align8(sizeof(AssetPackHeader));
+    uint64_t next = align8(header.entriesOffset + assets.size() * sizeof(AssetPackEntry));
+    for (PackedAsset& asset : assets) {
+        asset.entry.pixelsOffset = next;
+        next = align8(next + asset.pixels.size());
+        asset.entry.glyphsOffset = next;
+        next = align8(next + asset.glyphs.size() * sizeof(AssetGlyph));
+    }
+
+    std::vector<char> out(next, 0);
+    std::memcpy(out.data(), &header, sizeof(header));
+    for (size_t i = 0; i < assets.size(); ++i) {
+        const PackedAsset& asset = assets[i];
+        std::memcpy(out.data() + header.entriesOffset + i * sizeof(AssetPackEntry), &asset.entry, sizeof(AssetPackEntry));
+        if (!asset.pixels.empty()) std::memcpy(out.data() + asset.entry.pixelsOffset, asset.pixels.data(), asset.pixels.size());
+        if (!asset.glyphs.empty()) std::memcpy(out.data() + asset.entry.glyphsOffset, asset.glyphs.data(), asset.glyphs.size() * sizeof(AssetGlyph));
+    }
+
+    std::ofstream file(argv[3], std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(out.data(), out.size())) {
+        std::cerr << "[asset_pack] Could not write " << argv[3] << "\n";
+        return 1;
+    }
+    std::cout << "[asset_pack] " << argv[3] << ": " << assets.size() << " assets, " << out.size() << " bytes\n";
+    return 0;
+}
@@ -0,0 +1,287 @@
+#include <engine/NetEmulator.h>
+#include <zmq.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Sits between game clients and a server and makes the link between them behave like a WAN,
+// so interpolation, prediction and bandwidth work can be measured on one machine.
+//
+//   netem_proxy [options]
+//     --listen <port>      clients connect here: snapshots on port, commands on port + 1 (default 6555)
+//     --server <address>   server to forward to (default tcp://localhost)
+//     --port <port>        the server's --port (default 5555)
+//     --delay <ms> --jitter <ms> --loss <0..1> --reorder <0..1> --reorder-ms <ms>
+//     --rate <kbit/s> --queue <ms>
+//                          link conditions for both directions, prefix with up- (client to server)
+//                          or down- (server to client) for one, e.g. --down-rate 256
+//     --script <file>      timed changes, one per line: <seconds> <name> <value> [<name> <value> ...]
+//                          with the option names above without the dashes, e.g. "10 delay 150 loss 0.05"
+//     --duration <s>       exit after this long, for scripted runs (default: run until killed)
+//     --seed <n>           random seed, so a scripted run drops the same messages each time
+//
+// Then start the game with --port <listen>. Counts for each direction are printed once a second.
+
+using Clock = std::chrono::steady_clock;
+
+// Where a message held by the emulators goes once it's due
+enum Channel { Snapshot = 0, Command = 1, Reply = 2 };
+
+static uint64_t nowNS() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+// One scripted change, applied once the run is atSeconds old
+struct ScriptStep {
+    float atSeconds;
+    std::vector<std::pair<std::string, float>> settings;
+};
+
+/**
+ * Applies one setting by option name to the matching directions.
+ * @param name The option without dashes, optionally prefixed with up- or down-.
+ * @param value The value.
+ * @return false if the name isn't a link setting.
+ */
+static bool applySetting(const std::string& name, float value, LinkConditions& up, LinkConditions& down) {
+    std::string key = name;
+    bool toUp = true, toDown = true;
+    if (key.compare(0, 3, "up-") == 0) { key = key.substr(3); toDown = false; }
+    else if (key.compare(0, 5, "down-") == 0) { key = key.substr(5); toUp = false; }
+
+    float LinkConditions::* field = nullptr;
+    if (key == "delay") field = &LinkConditions::delayMs;
+    else if (key == "jitter") field = &LinkConditions::jitterMs;
+    else if (key == "loss") field = &LinkConditions::loss;
+    else if (key == "reorder") field = &LinkConditions::reorder;
+    else if (key == "reorder-ms") field = &LinkConditions::reorderMs;
+    else if (key == "rate") field = &LinkConditions::rateKbps;
+    else if (key == "queue") field = &LinkConditions::queueMs;
+    else return false;
+
+    if (toUp) up.*field = value;
+    if (toDown) down.*field = value;
+    return true;
+}
+
+// Reads a script file, steps come back sorted by time
+static bool loadScript(const std::string& path, std::vector<ScriptStep>& steps) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "[netem_proxy] Can't open script " << path << "\n";
+        return false;
+    }
+    LinkConditions checkUp, checkDown;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        ScriptStep step;
+        if (!(fields >> step.atSeconds)) continue;
+        std::string name;
+        float value;
+        while (fields >> name >> value) {
+            if (!applySetting(name, value, checkUp, checkDown)) {
+                std::cerr << "[netem_proxy] " << path << ":" << lineNumber << ": unknown setting " << name << "\n";
+                return false;
+            }
+            step.settings.push_back({ name, value });
+        }
+        steps.push_back(step);
+    }
+    std::stable_sort(steps.begin(), steps.end(),
+        [](const ScriptStep& a, const ScriptStep& b) { return a.atSeconds < b.atSeconds; });
+    return true;
+}
+
+static void printConditions(const char* direction, const LinkConditions& c) {
+    std::printf("[netem_proxy] %-4s delay %.0f ms, jitter %.0f ms, loss %.1f%%, reorder %.1f%%, rate %s\n",
+        direction, c.delayMs, c.jitterMs, c.loss * 100.0f, c.reorder * 100.0f,
+        c.rateKbps > 0.0f ? (std::to_string(static_cast<int>(c.rateKbps)) + " kbit/s").c_str() : "unlimited");
+}
+
+// Receives every frame of one message, false if nothing was waiting
+static bool recvMessage(zmq::socket_t& socket, std::vector<std::string>& frames) {
+    frames.clear();
+    zmq::message_t frame;
+    if (!socket.recv(frame, zmq::recv_flags::dontwait)) return false;
+    frames.push_back(frame.to_string());
+    while (frame.more()) {
+        if (!socket.recv(frame, zmq::recv_flags::none)) break;
+        frames.push_back(frame.to_string());
+    }
+    return true;
+}
+
+// Sends frames[first..] as one message
+static void sendMessage(zmq::socket_t& socket, const std::vector<std::string>& frames, size_t first) {
+    for (size_t i = first; i < frames.size(); ++i) {
+        const bool last = i + 1 == frames.size();
+        socket.send(zmq::buffer(frames[i]), last ? zmq::send_flags::dontwait : zmq::send_flags::sndmore);
+    }
+}
+
+// The proxy's connection to the server for one client. Each client gets its own, so the server
+// still sees one REQ style peer per player.
+struct Upstream {
+    zmq::socket_t socket;
+    uint64_t lastUsedNS = 0;
+};
+
+int main(int argc, char* argv[]) {
+    int listenPort = 6555;
+    int serverPort = 5555;
+    std::string serverAddress = "tcp://localhost";
+    std::string scriptPath;
+    float durationSeconds = 0.0f;
+    uint32_t seed = 1;
+    LinkConditions upConditions, downConditions;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        const char* value = argv[i + 1];
+        if (arg == "--listen") listenPort = std::atoi(value);
+        else if (arg == "--server") serverAddress = value;
+        else if (arg == "--port") serverPort = std::atoi(value);
+        else if (arg == "--script") scriptPath = value;
+        else if (arg == "--duration") durationSeconds = static_cast<float>(std::atof(value));
+        else if (arg == "--seed") seed = static_cast<uint32_t>(std::strtoul(value, nullptr, 10));
+        else if (arg.compare(0, 2, "--") != 0 ||
+            !applySetting(arg.substr(2), static_cast<float>(std::atof(value)), upConditions, downConditions)) {
+            std::cerr << "[netem_proxy] Unknown option " << arg << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<ScriptStep> script;
+    if (!scriptPath.empty() && !loadScript(scriptPath, script)) return 1;
+    size_t nextStep = 0;
+
+    LinkEmulator up(seed), down(seed + 1);
+    up.setConditions(upConditions);
+    down.setConditions(downConditions);
+
+    zmq::context_t context(1);
+    const std::string commandAddress = serverAddress + ":" + std::to_string(serverPort + 1);
+
+    // Server to clients: snapshots are taken from the server's PUB and republished to the clients
+    zmq::socket_t serverSnapshots(context, zmq::socket_type::sub);
+    serverSnapshots.connect(serverAddress + ":" + std::to_string(serverPort));
+    serverSnapshots.set(zmq::sockopt::subscribe, "");
+    zmq::socket_t clientSnapshots(context, zmq::socket_type::pub);
+    clientSnapshots.bind("tcp://*:" + std::to_string(listenPort));
+
+    // Clients to server: commands arrive on a ROUTER and leave on the sender's own upstream socket
+    zmq::socket_t clientCommands(context, zmq::socket_type::router);
+    clientCommands.bind("tcp://*:" + std::to_string(listenPort + 1));
+    std::unordered_map<std::string, std::unique_ptr<Upstream>> upstreams;
+
+    std::cout << "[netem_proxy] Clients connect to port " << listenPort << ", forwarding to "
+              << serverAddress << ":" << serverPort << "\n";
+    printConditions("up", upConditions);
+    printConditions("down", downConditions);
+
+    const uint64_t startNS = nowNS();
+    uint64_t reportNS = startNS;
+    std::vector<std::string> frames;
+    std::vector<zmq::pollitem_t> items;
+    std::vector<const std::string*> itemClients; // identity behind each upstream poll item
+    EmulatedMessage due;
+
+    while (durationSeconds <= 0.0f || nowNS() - startNS < static_cast<uint64_t>(durationSeconds * 1e9)) {
+        uint64_t now = nowNS();
+
+        // Scripted changes that have come due
+        bool changed = false;
+        while (nextStep < script.size() && (now - startNS) / 1e9 >= script[nextStep].atSeconds) {
+            for (const auto& [name, value] : script[nextStep].settings) applySetting(name, value, upConditions, downConditions);
+            std::printf("[netem_proxy] t=%.1f s:\n", script[nextStep].atSeconds);
+            ++nextStep;
+            changed = true;
+        }
+        if (changed) {
+            up.setConditions(upConditions);
+            down.setConditions(downConditions);
+            printConditions("up", upConditions);
+            printConditions("down", downConditions);
+        }
+
+        // Wake for new messages, or when the next held one is due
+        items.clear();
+        itemClients.clear();
+        items.push_back({ serverSnapshots.handle(), 0, ZMQ_POLLIN, 0 });
+        items.push_back({ clientCommands.handle(), 0, ZMQ_POLLIN, 0 });
+        for (auto& [identity, upstream] : upstreams) {
+            items.push_back({ upstream->socket.handle(), 0, ZMQ_POLLIN, 0 });
+            itemClients.push_back(&identity);
+        }
+        int timeoutMs = 100;
+        const int upWait = up.msUntilNext(now), downWait = down.msUntilNext(now);
+        if (upWait >= 0) timeoutMs = std::min(timeoutMs, upWait);
+        if (downWait >= 0) timeoutMs = std::min(timeoutMs, downWait);
+        zmq::poll(items, std::chrono::milliseconds(timeoutMs));
+        now = nowNS();
+
+        if (items[0].revents & ZMQ_POLLIN) {
+            while (recvMessage(serverSnapshots, frames)) down.submit({ Snapshot, frames }, now);
+        }
+        if (items[1].revents & ZMQ_POLLIN) {
+            while (recvMessage(clientCommands, frames)) up.submit({ Command, frames }, now); // identity, empty, command
+        }
+        for (size_t i = 2; i < items.size(); ++i) {
+            if (!(items[i].revents & ZMQ_POLLIN)) continue;
+            const std::string& identity = *itemClients[i - 2];
+            zmq::socket_t& socket = upstreams[identity]->socket;
+            while (recvMessage(socket, frames)) {
+                frames.insert(frames.begin(), identity); // empty, reply becomes the client's envelope
+                down.submit({ Reply, frames }, now);
+            }
+        }
+
+        // Send whatever the emulated link has delivered
+        while (up.take(now, due)) {
+            std::unique_ptr<Upstream>& upstream = upstreams[due.frames[0]];
+            if (!upstream) {
+                upstream.reset(new Upstream{ zmq::socket_t(context, zmq::socket_type::dealer) });
+                upstream->socket.set(zmq::sockopt::linger, 0);
+                upstream->socket.connect(commandAddress);
+            }
+            upstream->lastUsedNS = now;
+            sendMessage(upstream->socket, due.frames, 1);
+        }
+        while (down.take(now, due)) {
+            if (due.channel == Snapshot) sendMessage(clientSnapshots, due.frames, 0);
+            else sendMessage(clientCommands, due.frames, 0);
+        }
+
+        // Once a second: counts, and forget clients that went quiet
+        if (now - reportNS >= 1000000000ull) {
+            const LinkStats u = up.takeStats(), d = down.takeStats();
+            std::printf("[netem_proxy] %6.1f s | up %4llu sent %3llu lost %3llu full %3llu reord %7.1f KB/s"
+                " | down %4llu sent %3llu lost %3llu full %3llu reord %7.1f KB/s\n",
+                (now - startNS) / 1e9,
+                (unsigned long long)u.delivered, (unsigned long long)u.lost, (unsigned long long)u.overflowed,
+                (unsigned long long)u.reordered, u.bytes / 1024.0 / ((now - reportNS) / 1e9),
+                (unsigned long long)d.delivered, (unsigned long long)d.lost, (unsigned long long)d.overflowed,
+                (unsigned long long)d.reordered, d.bytes / 1024.0 / ((now - reportNS) / 1e9));
+            std::fflush(stdout);
+            reportNS = now;
+
+            for (auto it = upstreams.begin(); it != upstreams.end();) {
+                if (now - it->second->lastUsedNS > 10000000000ull) it = upstreams.erase(it);
+                else ++it;
+            }
+        }
+    }
+    return 0;
+}
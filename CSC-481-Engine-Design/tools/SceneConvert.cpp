@@ -0,0 +1,159 @@
+#include <engine/Scene.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Builds a binary .scene from a text scene.
+//
+//   scene_convert <level.scene.txt> <out.scene>
+//
+// One record per line, '#' starts a comment:
+//   tilemap assets/level1.tmap                       level tiles, at most one
+//   texture <name> <path>                            entry in the texture table
+//   entity <kind> <texture|-> <x> <y> <w> <h> [static] [collidable] [gravity]
+//   object <id> <type> <x> <y> <w> <h> <vx> <vy> [<minX> <maxX>]
+//
+// Entities are created on the client by the factory the game registers for <kind>.
+// Objects are simulated by the server and sent to clients in snapshots.
+
+// Collects strings once each and hands out their offsets
+struct StringTable {
+    std::string bytes;
+    std::unordered_map<std::string, uint32_t> offsets;
+
+    uint32_t add(const std::string& s) {
+        auto it = offsets.find(s);
+        if (it != offsets.end()) return it->second;
+        const uint32_t offset = static_cast<uint32_t>(bytes.size());
+        bytes.append(s);
+        bytes.push_back('\0');
+        offsets.emplace(s, offset);
+        return offset;
+    }
+};
+
+static uint64_t align8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "usage: scene_convert <level.scene.txt> <out.scene>\n";
+        return 1;
+    }
+
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "[scene_convert] Could not open " << argv[1] << "\n";
+        return 1;
+    }
+
+    StringTable strings;
+    std::vector<uint32_t> textures;
+    std::unordered_map<std::string, uint32_t> textureIndex;
+    std::vector<SceneEntity> entities;
+    std::vector<SceneObject> objects;
+    uint32_t tilemap = Scene::kNone;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string key;
+        if (!(words >> key)) continue;
+
+        bool ok = true;
+        if (key == "tilemap") {
+            std::string path;
+            ok = static_cast<bool>(words >> path);
+            if (ok) tilemap = strings.add(path);
+        }
+        else if (key == "texture") {
+            std::string name, path;
+            ok = static_cast<bool>(words >> name >> path);
+            if (ok) {
+                textureIndex[name] = static_cast<uint32_t>(textures.size());
+                textures.push_back(strings.add(path));
+            }
+        }
+        else if (key == "entity") {
+            std::string kind, texture;
+            SceneEntity e{};
+            ok = static_cast<bool>(words >> kind >> texture >> e.x >> e.y >> e.w >> e.h);
+            if (ok) {
+                e.kind = strings.add(kind);
+                e.texture = Scene::kNone;
+                if (texture != "-") {
+                    auto it = textureIndex.find(texture);
+                    if (it == textureIndex.end()) {
+                        std::cerr << "[scene_convert] Line " << lineNumber << ": unknown texture " << texture << "\n";
+                        return 1;
+                    }
+                    e.texture = it->second;
+                }
+                std::string flag;
+                while (ok && words >> flag) {
+                    if (flag == "static") e.flags |= SceneEntity::Static;
+                    else if (flag == "collidable") e.flags |= SceneEntity::Collidable;
+                    else if (flag == "gravity") e.flags |= SceneEntity::Gravity;
+                    else ok = false;
+                }
+                entities.push_back(e);
+            }
+        }
+        else if (key == "object") {
+            SceneObject o{};
+            ok = static_cast<bool>(words >> o.id >> o.type >> o.x >> o.y >> o.w >> o.h >> o.vx >> o.vy);
+            if (ok && !(words >> o.minX >> o.maxX)) {
+                o.minX = o.maxX = 0.0f; // no patrol range
+            }
+            if (ok) objects.push_back(o);
+        }
+        else {
+            ok = false;
+        }
+
+        if (!ok) {
+            std::cerr << "[scene_convert] Line " << lineNumber << " is not valid: " << line << "\n";
+            return 1;
+        }
+    }
+
+    // Lay out the sections, each on an 8 byte boundary
+    SceneHeader header{};
+    std::memcpy(header.magic, "CSCSCEN", 8);
+    header.version = Scene::kVersion;
+    header.textureCount = static_cast<uint32_t>(textures.size());
+    header.entityCount = static_cast<uint32_t>(entities.size());
+    header.objectCount = static_cast<uint32_t>(objects.size());
+    header.stringsSize = static_cast<uint32_t>(strings.bytes.size());
+    header.tilemap = tilemap;
+    header.texturesOffset = align8(sizeof(SceneHeader));
+    header.entitiesOffset = align8(header.texturesOffset + textures.size() * sizeof(uint32_t));
+    header.objectsOffset = align8(header.entitiesOffset + entities.size() * sizeof(SceneEntity));
+    header.stringsOffset = align8(header.objectsOffset + objects.size() * sizeof(SceneObject));
+
+    std::vector<char> out(header.stringsOffset + strings.bytes.size(), 0);
+    std::memcpy(out.data(), &header, sizeof(header));
+    if (!textures.empty()) std::memcpy(out.data() + header.texturesOffset, textures.data(), textures.size() * sizeof(uint32_t));
+    if (!entities.empty()) std::memcpy(out.data() + header.entitiesOffset, entities.data(), entities.size() * sizeof(SceneEntity));
+    if (!objects.empty()) std::memcpy(out.data() + header.objectsOffset, objects.data(), objects.size() * sizeof(SceneObject));
+    std::memcpy(out.data() + header.stringsOffset, strings.bytes.data(), strings.bytes.size());
+
+    std::ofstream file(argv[2], std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(out.data(), out.size())) {
+        std::cerr << "[scene_convert] Could not write " << argv[2] << "\n";
+        return 1;
+    }
+
+    std::cout << "[scene_convert] " << argv[2] << ": " << entities.size() << " entities, " << objects.size()
+              << " objects, " << textures.size() << " textures, " << out.size() << " bytes\n";
+    return 0;
+}
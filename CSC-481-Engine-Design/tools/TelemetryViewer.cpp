@@ -0,0 +1,58 @@
+#include <engine/Protocol.h>
+#include <zmq.hpp>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+// Shows the stats a server publishes on its telemetry endpoint, one row per message.
+//
+//   telemetry_viewer [endpoint]          default tcp://127.0.0.1:5570, the server's default
+//
+// Tick is the furthest any room has got. Tick times are the work one room's tick does, overruns are ticks longer than the 33 ms period.
+// Lock columns are average / longest wait in microseconds.
+
+static void printHeader() {
+    std::printf("%8s %5s %7s | %7s %7s %7s %7s %5s | %8s %10s | %15s %15s\n",
+        "tick", "rooms", "clients", "p50 ms", "p95 ms", "p99 ms", "max ms", "over",
+        "cmd/s", "snap KB/s", "rooms lock us", "objects lock us");
+}
+
+int main(int argc, char* argv[]) {
+    const std::string endpoint = argc > 1 ? argv[1] : "tcp://127.0.0.1:5570";
+
+    zmq::context_t context(1);
+    zmq::socket_t subscriber(context, zmq::socket_type::sub);
+    subscriber.connect(endpoint);
+    subscriber.set(zmq::sockopt::subscribe, "STATS");
+    std::cout << "[telemetry_viewer] Watching " << endpoint << "\n";
+
+    int rows = 0;
+    bool waiting = false;
+    while (true) {
+        zmq::pollitem_t items[] = { { subscriber.handle(), 0, ZMQ_POLLIN, 0 } };
+        zmq::poll(items, 1, std::chrono::milliseconds(3000));
+        if (!(items[0].revents & ZMQ_POLLIN)) {
+            // Stats come every second, three missing means the server is gone or stuck
+            if (!waiting) std::cout << "[telemetry_viewer] No stats for 3 s, waiting...\n";
+            waiting = true;
+            continue;
+        }
+        waiting = false;
+
+        zmq::message_t msg;
+        if (!subscriber.recv(msg, zmq::recv_flags::none)) continue;
+        ServerStats s;
+        if (!Protocol::decodeStats(static_cast<const char*>(msg.data()), msg.size(), s)) {
+            std::cerr << "[telemetry_viewer] Malformed stats message\n";
+            continue;
+        }
+
+        if (rows++ % 20 == 0) printHeader();
+        std::printf("%8d %5d %7d | %7.2f %7.2f %7.2f %7.2f %5u | %8.1f %10.1f | %7.1f/%-7.1f %7.1f/%-7.1f\n",
+            s.tick, s.rooms, s.clients, s.tickP50Ms, s.tickP95Ms, s.tickP99Ms, s.tickMaxMs, s.overruns,
+            s.commandsPerSec, s.snapshotBytesPerSec / 1024.0f,
+            s.roomsLockAvgUs, s.roomsLockMaxUs, s.objectsLockAvgUs, s.objectsLockMaxUs);
+        std::fflush(stdout);
+    }
+}
@@ -0,0 +1,146 @@
+#include <engine/Tilemap.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Builds a binary .tmap level from a text level.
+//
+//   tilemap_build <level.txt> <out.tmap>
+//
+// Text format, one directive per line until "map", '#' starts a comment before it:
+//   tilesize 32                       world pixels per tile
+//   chunk 16                          tiles per chunk side
+//   tileset assets/Brick.png 1 1      texture, columns, rows
+//   map
+//   ....##########.....               one row per line: '.' or ' ' empty, '#' tile 1, '1'-'9' that tile
+//
+// Rows can have any length, the map is as wide as the longest one and padded to whole chunks.
+// Chunks with no tiles are not stored at all.
+
+// Tile id for one map character
+static uint16_t tileFor(char c) {
+    if (c == '#') return 1;
+    if (c >= '1' && c <= '9') return static_cast<uint16_t>(c - '0');
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "usage: tilemap_build <level.txt> <out.tmap>\n";
+        return 1;
+    }
+
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "[tilemap_build] Could not open " << argv[1] << "\n";
+        return 1;
+    }
+
+    TilemapHeader header{};
+    std::memcpy(header.magic, "CSCTMAP", 8);
+    header.version = Tilemap::kVersion;
+    header.tileSize = 32;
+    header.chunkSize = 16;
+    header.tilesetColumns = 1;
+    header.tilesetRows = 1;
+
+    // Directives, then rows
+    std::vector<std::string> rows;
+    std::string line;
+    bool inMap = false;
+    while (std::getline(in, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (inMap) {
+            rows.push_back(line);
+            continue;
+        }
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream words(line);
+        std::string key;
+        words >> key;
+        if (key == "tilesize") {
+            words >> header.tileSize;
+        }
+        else if (key == "chunk") {
+            words >> header.chunkSize;
+        }
+        else if (key == "tileset") {
+            std::string path;
+            words >> path >> header.tilesetColumns >> header.tilesetRows;
+            if (path.size() >= sizeof(header.tileset)) {
+                std::cerr << "[tilemap_build] Tileset path too long: " << path << "\n";
+                return 1;
+            }
+            std::strncpy(header.tileset, path.c_str(), sizeof(header.tileset) - 1);
+        }
+        else if (key == "map") {
+            inMap = true;
+        }
+        else {
+            std::cerr << "[tilemap_build] Unknown directive: " << key << "\n";
+            return 1;
+        }
+    }
+    if (header.tileSize == 0 || header.chunkSize == 0 || rows.empty()) {
+        std::cerr << "[tilemap_build] " << argv[1] << " needs a tilesize, a chunk size and a map\n";
+        return 1;
+    }
+
+    size_t width = 0;
+    for (const std::string& row : rows) width = std::max(width, row.size());
+    const uint32_t n = header.chunkSize;
+    header.chunksX = static_cast<uint32_t>((width + n - 1) / n);
+    header.chunksY = static_cast<uint32_t>((rows.size() + n - 1) / n);
+    if (header.chunksX == 0) header.chunksX = 1;
+
+    // Cut the map into chunks, keeping only the ones with tiles
+    const size_t chunkCount = static_cast<size_t>(header.chunksX) * header.chunksY;
+    std::vector<uint64_t> offsets(chunkCount, 0);
+    std::vector<uint16_t> data;
+    uint64_t next = sizeof(TilemapHeader) + chunkCount * sizeof(uint64_t);
+    size_t tileCount = 0;
+    for (uint32_t cy = 0; cy < header.chunksY; ++cy) {
+        for (uint32_t cx = 0; cx < header.chunksX; ++cx) {
+            std::vector<uint16_t> tiles(static_cast<size_t>(n) * n, 0);
+            bool any = false;
+            for (uint32_t ty = 0; ty < n; ++ty) {
+                const size_t y = static_cast<size_t>(cy) * n + ty;
+                if (y >= rows.size()) break;
+                for (uint32_t tx = 0; tx < n; ++tx) {
+                    const size_t x = static_cast<size_t>(cx) * n + tx;
+                    if (x >= rows[y].size()) break;
+                    const uint16_t id = tileFor(rows[y][x]);
+                    tiles[ty * n + tx] = id;
+                    if (id != 0) { any = true; ++tileCount; }
+                }
+            }
+            if (!any) continue;
+            offsets[cy * header.chunksX + cx] = next;
+            next += tiles.size() * sizeof(uint16_t);
+            data.insert(data.end(), tiles.begin(), tiles.end());
+        }
+    }
+
+    std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "[tilemap_build] Could not write " << argv[2] << "\n";
+        return 1;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    out.write(reinterpret_cast<const char*>(data.data()), data.size() * sizeof(uint16_t));
+    if (!out) {
+        std::cerr << "[tilemap_build] Write to " << argv[2] << " failed\n";
+        return 1;
+    }
+
+    std::cout << "[tilemap_build] " << argv[2] << ": " << width << "x" << rows.size() << " tiles, "
+              << tileCount << " solid, " << header.chunksX << "x" << header.chunksY << " chunks ("
+              << data.size() / (static_cast<size_t>(n) * n) << " stored)\n";
+    return 0;
+}
@@ -1,121 +1,168 @@
-#include "Player.h"
-#include "Actions.h"
-#include "Static.h"  
-#include "Auto.h"
-#include <engine/Collision.h>
-#include <engine/Physics.h>
-#include <engine/Input.h>
-#include <engine/Engine.h>
-#include <vector>
-
-
-// Player entity with gravity and collision on by default
-Player::Player(float x, float y, float w, float h, const char* texturePath)
-    : Entity(x, y, w, h, texturePath, true, true) {
-}
-
-void Player::update(float deltaTime) {
-
-	if (paused) return;
-	
-	// Dodge timer
-	if (dodgeActive) {
-		dodgeTimer -= deltaTime;
-		if (dodgeTimer <= 0.0f) {
-			dodgeActive = false;
-		}
-	}
-
-	// Apply physics
-	Entity::update(deltaTime);
-
-	
-	isOnGround = false;
-
-	// Platform collisions first to compute isOnGround
-	{
-		const std::vector<Entity*> ents = Engine::getEntitiesSnapshot();
-		for (Entity* e : ents) {
-			if (e == this || !e->isCollidable()) continue;
-
-			// Only treat Static as ground/platform
-			if (auto* platform = dynamic_cast<Static*>(e)) {
-				const float platformTop = platform->getPosition().y;
-				const float playerBottom = getPosition().y + getRect().h;
-
-				if (playerBottom >= platformTop && Collision::checkCollision(*this, *platform)) {
-					// Snap to top and zero vertical velocity
-					OrderedPair pos = getPosition();
-					pos.y = platformTop - getRect().h;
-					setPosition(pos);
-
-					Velocity v = getVelocity();
-					v.direction = { 0, 0 };
-					v.magnitude = 0.0f;
-					setVelocity(v);
-
-					isOnGround = true;
-				}
-			}
-		}
-	}
-
-	// Handle actions now 
-	const uint32_t actions = getPendingActions();
-	if ((actions & ACTION_DODGE) && !dodgeActive) {
-		startDodge();
-	}
-	if (isOnGround && (actions & ACTION_JUMP)) {
-		jump();
-	}
-	setPendingActions(0); // clear for next frame
-
-	// Orb collisions after dodge is possibly active
-	{
-		const std::vector<Entity*> ents = Engine::getEntitiesSnapshot();
-		for (Entity* e : ents) {
-			if (e == this || !e->isCollidable()) continue;
-
-			// Only treat Auto as the hazard
-			if (auto* orb = dynamic_cast<Auto*>(e)) {
-				if (Collision::checkCollision(*this, *orb) && !dodgeActive) {
-					handleCollision(*orb); // respawn only if not dodging
-				}
-			}
-		}
-	}
-}
-
-
-// Handles collision with the orb by resetting player position and velocity
-void Player::handleCollision(const Entity& other) {
-	// Reset position/velocity on orb hit
-	setPosition({ 300.0f, 500.0f });
-	setVelocity({ {0, 0}, 0 });
-}
-
-// Initiates the dodge state
-void Player::startDodge() {
-    dodgeActive = true;
-    dodgeTimer = dodgeDuration;
-}
-
-// Makes the player jump if on the ground
-void Player::jump() {
-    Velocity v = getVelocity();
-    v.direction.x = 0;
-    v.direction.y = -1;  // Upward direction
-    v.magnitude = 500.0f;  // Tune this value to jump height
-    setVelocity(v);
-}
-
-void Player::setPaused(bool p) {
-	paused = p;
-	if (paused) {
-		// Zero out velocity so you truly "hang" midair.
-		Velocity v = getVelocity();
-		v.direction = { 0, 0 };
-		v.magnitude = 0.0f;
-		setVelocity(v);
-	}
-}
+#include "Player.h"
+#include "Actions.h"
+#include "Static.h"  
+#include "Auto.h"
+#include <engine/Collision.h>
+#include <engine/Physics.h>
+#include <engine/Input.h>
+#include <engine/Engine.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+
+// Player entity with gravity and collision on by default
+Player::Player(float x, float y, float w, float h, const char* texturePath)
+    : Entity(x, y, w, h, texturePath, true, true) {
+}
+
+void Player::update(float deltaTime) {
+
+	// A server hit is seen on the main thread, so the respawn it asks for happens here
+	if (respawnRequested.exchange(false)) respawn();
+
+	// Paused from the main thread, so the hang in midair is applied here on the update thread
+	if (paused.load()) {
+		setVelocity({ {0, 0}, 0 });
+		return;
+	}
+	
+	// Dodge timer
+	if (dodgeActive) {
+		dodgeTimer -= deltaTime;
+		if (dodgeTimer <= 0.0f) {
+			dodgeActive = false;
+		}
+	}
+
+	// Apply physics to the velocity, the move itself is swept against platforms below
+	const OrderedPair start = getPosition();
+	const SDL_FRect startRect = getRect();
+	OrderedPair end = start;
+	OrderedPair vel = getVelocityComponents();
+	const OrderedPair gravity = isAffectedByGravity() ? Physics::getGravityAcceleration() : OrderedPair{};
+	Physics::integrate(end, vel, gravity, deltaTime);
+	setVelocityComponents(vel);
+	const OrderedPair displacement = { end.x - start.x, end.y - start.y };
+
+	isOnGround = false;
+
+	// Platforms live in the engine's static BVH and level tiles in the tilemap's loaded chunks,
+	// so only the ones near this move are checked. The lists are per thread and reused by every
+	// player, so updates stop allocating once they have grown to the busiest spot in the level.
+	thread_local std::vector<Entity*> platforms;
+	thread_local std::vector<SDL_FRect> tiles;
+	platforms.clear();
+	tiles.clear();
+	{
+		const float pad = 1.0f; // include platforms we are resting on
+		SDL_FRect area;
+		area.x = std::min(startRect.x, startRect.x + displacement.x) - pad;
+		area.y = std::min(startRect.y, startRect.y + displacement.y) - pad;
+		area.w = startRect.w + std::fabs(displacement.x) + 2 * pad;
+		area.h = startRect.h + std::fabs(displacement.y) + 2 * pad;
+		Engine::queryStatic(area, platforms);
+		if (Tilemap* tilemap = Engine::getTilemap()) tilemap->query(area, tiles);
+	}
+
+	// Stop at the earliest platform contact so fast falls can't pass through thin platforms
+	{
+		SweepHit hits[2];
+		const int hitCount = Collision::moveAndCollide(*this, displacement, platforms, tiles, hits, 2);
+		for (int i = 0; i < hitCount; ++i) {
+			if (hits[i].normal.y < 0.0f) isOnGround = true; // landed on top
+		}
+	}
+
+	// Platform overlaps left over (e.g. spawned inside one) snap to the top
+	{
+		for (Entity* platform : platforms) {
+			if (platform->isCollidable()) tiles.push_back(platform->getRect());
+		}
+		for (const SDL_FRect& platform : tiles) {
+			const float platformTop = platform.y;
+			const float playerBottom = getPosition().y + getRect().h;
+
+			if (playerBottom >= platformTop && Collision::checkCollision(getRect(), platform)) {
+				// Snap to top and zero vertical velocity
+				OrderedPair pos = getPosition();
+				pos.y = platformTop - getRect().h;
+				setPosition(pos);
+
+				Velocity v = getVelocity();
+				v.direction = { 0, 0 };
+				v.magnitude = 0.0f;
+				setVelocity(v);
+
+				isOnGround = true;
+			}
+		}
+	}
+
+	// Handle actions now 
+	const uint32_t actions = getPendingActions();
+	if ((actions & ACTION_DODGE) && !dodgeActive) {
+		startDodge();
+	}
+	if (isOnGround && (actions & ACTION_JUMP)) {
+		jump();
+	}
+	setPendingActions(0); // clear for next tick
+
+	// Orb collisions after dodge is possibly active, unless the server decides them
+	if (!serverHits) {
+		// Only Auto is a hazard, so only Autos are visited
+		for (Auto* orb : Engine::each<Auto>()) {
+			if (!orb->isCollidable()) continue;
+
+			// Swept so a fast step can't skip over it
+			SweepHit hit;
+			const bool touched = Collision::checkCollision(*this, *orb) ||
+				Collision::sweep(startRect, displacement, orb->getRect(), hit);
+			if (touched && !dodgeActive) {
+				handleCollision(*orb); // respawn only if not dodging
+			}
+		}
+	}
+}
+
+
+// Handles collision with the orb by resetting player position and velocity
+void Player::handleCollision(const Entity& other) {
+	respawn();
+}
+
+// Reset position/velocity, for an orb hit
+void Player::respawn() {
+	setPosition({ 300.0f, 500.0f });
+	setVelocity({ {0, 0}, 0 });
+}
+
+// For a server hit, seen on the main thread. Applied at the top of the next update
+void Player::requestRespawn() {
+	respawnRequested.store(true);
+}
+
+void Player::setServerHits(bool enabled) {
+	serverHits = enabled;
+}
+
+// Initiates the dodge state
+void Player::startDodge() {
+    dodgeActive = true;
+    dodgeTimer = dodgeDuration;
+}
+
+// Makes the player jump if on the ground
+void Player::jump() {
+    Velocity v = getVelocity();
+    v.direction.x = 0;
+    v.direction.y = -1;  // Upward direction
+    v.magnitude = 500.0f;  // Tune this value to jump height
+    setVelocity(v);
+}
+
+// Safe from any thread, the next update zeroes the velocity so you truly "hang" midair
+void Player::setPaused(bool p) {
+	paused.store(p);
+}
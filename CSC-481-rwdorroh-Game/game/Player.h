@@ -1,28 +1,41 @@
-#pragma once
-#include <engine/Entity.h>
-
-class Player : public Entity {
-public:
-    Player(float x, float y, float w, float h, const char* texturePath);
-
-    void update(float deltaTime) override;
-
-	void setPaused(bool p);
-
-private:
-    bool isOnGround = false;
-
-    // Dodge state
-    bool dodgeActive = false;
-    float dodgeTimer = 0.0f;
-    const float dodgeDuration = 3.0f; // seconds
-
-    // Inputs
-    void jump();
-    void startDodge();
-
-    void handleCollision(const Entity& other);
-
-	bool paused = false;
-
+#pragma once
+#include <engine/Entity.h>
+#include <engine/NetworkTypes.h>
+#include <atomic>
+
+class Player : public Entity {
+public:
+    Player(float x, float y, float w, float h, const char* texturePath);
+
+    void update(float deltaTime) override;
+
+	void setPaused(bool p);
+
+	// Back to the spawn point, at rest. Only from the update thread, other threads use requestRespawn
+	void respawn();
+
+	// Safe from any thread, the next update respawns
+	void requestRespawn();
+
+	// With a server, orb hits come from it (see respawn) instead of being checked here
+	void setServerHits(bool enabled);
+
+private:
+    bool isOnGround = false;
+
+    // Dodge state
+    bool dodgeActive = false;
+    float dodgeTimer = 0.0f;
+    const float dodgeDuration = HAZARD_DODGE_SECONDS; // seconds, the server times dodges the same
+
+    // Inputs
+    void jump();
+    void startDodge();
+
+    void handleCollision(const Entity& other);
+
+	std::atomic<bool> paused{ false }; // set by the main thread, read by the update thread
+	std::atomic<bool> respawnRequested{ false }; // set by the main thread, taken by the update thread
+	bool serverHits = false;
+
 };
\ No newline at end of file
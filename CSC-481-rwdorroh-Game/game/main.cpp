@@ -1,261 +1,440 @@
-﻿#include <SDL3/SDL.h>
-#include <SDL3_image/SDL_image.h>
-#include <SDL3_ttf/SDL_ttf.h>
-#include <iostream>
-#include <string>
-#include <unordered_map>
-#include <vector>
-#include <sstream>
-
-#include "Static.h"
-#include "Player.h"
-#include "Auto.h"
-#include "Actions.h"
-
-#include <engine/Engine.h>
-#include <engine/Input.h>
-#include <engine/Physics.h>
-#include <engine/Client.h>
-#include <engine/Timeline.h>
-#include <engine/NetworkTypes.h>
-
-
-// Global font pointer for HUD
-TTF_Font* hudFont = nullptr;
-
-// Timeline speed levels
-const std::vector<float> speedLevels = { 0.5f, 1.0f, 2.0f };
-size_t currentSpeedIndex = 1;
-
-// Helper function to render text to a texture
-SDL_Texture* renderText(SDL_Renderer* renderer, TTF_Font* font, const std::string& text, SDL_Color color) {
-    SDL_Surface* surface = TTF_RenderText_Solid(font, text.c_str(), text.length(), color);
-    if (!surface) return nullptr;
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-    SDL_DestroySurface(surface);
-    return texture;
-}
-
-// Mutex + snapshot storage
-std::mutex stateMutex;
-struct ServerSnapshot {
-	std::unordered_map<int, OrderedPair> otherPlayersPositions;
-	std::vector<SyncedObjectData> syncedObjects;
-	bool valid = false;
-};
-ServerSnapshot latestSnapshot;
-
-// Bind actions for my game
-void setupInputBindings() {
-	Input::clearBindings();
-
-	// Networked actions
-	Input::bindAction(SDL_SCANCODE_W, 0); // Jump → bit 0
-	Input::bindAction(SDL_SCANCODE_S, 1); // Dodge → bit 1
-	Input::bindAction(SDL_SCANCODE_UP, 2); // Scale up
-	Input::bindAction(SDL_SCANCODE_DOWN, 3); // Scale down
-	Input::bindAction(SDL_SCANCODE_SPACE, 4); // Pause
-}
-
-// Network thread
-void networkReceiveThread(Client& net, int playerID) {
-	while (true) {
-		WorldSnapshot snapshot;
-		if (!net.pollUpdate(snapshot)) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
-			continue;
-		}
-		std::lock_guard<std::mutex> lock(stateMutex);
-		latestSnapshot.syncedObjects = snapshot.syncedObjects;
-		latestSnapshot.otherPlayersPositions.clear();
-		for (size_t i = 0; i < snapshot.playerIds.size(); ++i) {
-			if (snapshot.playerIds[i] != playerID) {
-				latestSnapshot.otherPlayersPositions[snapshot.playerIds[i]] =
-					snapshot.playerPositions[i];
-			}
-		}
-		latestSnapshot.valid = true;
-	}
-}
-
-int main(int argc, char* argv[]) {
-
-    // Ask for a player ID so each client is unique
-    int playerID;
-	std::cout << "Enter player ID (integer): ";
-	std::cin >> playerID;
-
-    // Set clientID with playerID
-	Client::setClientID(playerID);
-
-	// Configure the engine window
-    Engine::Config config;
-	config.title = "CSC 481 Game";
-	config.width = 1900;
-	config.height = 1000;
-
-	// TTF initialization
-    if (TTF_Init() < 0) {
-        SDL_Log("Failed to init TTF: %s", SDL_GetError());
-        return 1;
-    }
-
-	// Load font for HUD
-    hudFont = TTF_OpenFont("assets/DejaVuSans.ttf", 24);
-    if (!hudFont) {
-        SDL_Log("Failed to load font: %s", SDL_GetError());
-        return 1;
-    }
-
-    // Initialize the engine
-    if (!Engine::init(config)) {
-        SDL_Log("Failed to initialize engine: %s", SDL_GetError());
-        return 1;  // Failed to init SDL
-    }
-
-	// Setup input bindings (jump + dodge)
-	setupInputBindings();
-
-	// Increase gravity for this session
-	Physics::setGravity(200.0f);
-
-    // Initialize the timeline
-    Timeline timeline;
-    timeline.init();
-
-	// Set initial time scale
-	timeline.setScale(speedLevels[currentSpeedIndex]);
-	setupInputBindings();
-
-	// Initialize the client for networking
-	Client net;
-	bool isConnected = net.connect();
-
-	// Static platform
-	Engine::addEntity(new Static(300.0f, 800.0f, 96.0f, 32.0f, "assets/Brick.png"));
-
-	// Local player
-	Player* localPlayer = new Player(300.0f, 500.0f, 64.0f, 64.0f, "assets/Morwen.png");
-	Engine::addEntity(localPlayer);
-
-	// Map of other players in the game
-	std::unordered_map<int, Player*> otherPlayers;
-
-	// Auto-moving orb reference
-	Entity* orb = nullptr;
-
-	// Network receive thread
-	std::thread netThread;
-	if (isConnected) netThread = std::thread(networkReceiveThread, std::ref(net), playerID);
-
-	int currentTick = 0;
-	bool wasScaleUp = false, wasScaleDown = false, wasPause = false;
-
-    // Main game loop
-    Engine::run(
-        [&](float rawDelta) {
-
-			const uint32_t actionMask = Input::getActionMask();
-            
-            // Speed up with up arrow
-			bool scaleUp = (actionMask & ACTION_SCALE_UP);
-			if (scaleUp && !wasScaleUp && currentSpeedIndex < speedLevels.size() - 1) {
-				timeline.setScale(speedLevels[++currentSpeedIndex]);
-			}
-			wasScaleUp = scaleUp;
-
-			// Slow down with down arrow
-			bool scaleDown = (actionMask & ACTION_SCALE_DOWN);
-			if (scaleDown && !wasScaleDown && currentSpeedIndex > 0) {
-				timeline.setScale(speedLevels[--currentSpeedIndex]);
-			}
-			wasScaleDown = scaleDown;
-
-			// Handle pausing with Space
-			bool pause = (actionMask & ACTION_PAUSE);
-			if (pause && !wasPause) {
-				if (timeline.isPaused()) {
-					timeline.resume();
-					localPlayer->setPaused(false);
-				}
-				else {
-					timeline.pause();
-					localPlayer->setPaused(true);
-				}
-			}
-			wasPause = pause;
-
-            // Update the scaled timeline
-            float scaledDelta = static_cast<float>(timeline.update());
-			currentTick++;
-
-			if (timeline.isPaused()) {
-				return; // Skip all updates while paused
-			}
-
-			// Local player actions
-			localPlayer->setPendingActions(actionMask);
-			localPlayer->update(scaledDelta);
-
-			// Apply latest snapshot to orb + other players
-			{
-				std::lock_guard<std::mutex> lock(stateMutex);
-				if (latestSnapshot.valid) {
-					for (const auto& obj : latestSnapshot.syncedObjects) {
-						if (obj.id == 1 && obj.type == 1) { // Orb
-							if (!orb) {
-								orb = new Auto(obj.position.x, obj.position.y, 128, 128, "assets/Orb.png");
-								static_cast<Auto*>(orb)->setServerControlled(true);
-								Engine::addEntity(orb);
-							}
-							else {
-								orb->setPosition(obj.position);
-							}
-						}
-					}
-					for (auto& [id, pos] : latestSnapshot.otherPlayersPositions) {
-						if (otherPlayers.find(id) == otherPlayers.end()) {
-							Player* np = new Player(pos.x, pos.y, 64, 64, "assets/Morwen.png");
-							otherPlayers[id] = np;
-							Engine::addEntity(np);
-						}
-						else {
-							otherPlayers[id]->setPosition(pos);
-						}
-					}
-				}
-			}
-
-			// Send player state to server
-			if (isConnected) {
-				ClientCommand cmd{ playerID, currentTick, actionMask,
-								  localPlayer->getPosition().x, localPlayer->getPosition().y };
-				net.sendCommand(cmd);
-			}
-			localPlayer->setPendingActions(0);
-        },
-        [&]() {
-			SDL_Renderer* renderer = Engine::getRenderer();
-			SDL_Color black = { 0,0,0,255 };
-			std::stringstream ss;
-			ss << "Client ID: " << playerID << " | Speed: x" << timeline.getScale();
-			if (timeline.isPaused()) ss << " [PAUSED]";
-			SDL_Texture* tex = renderText(renderer, hudFont, ss.str(), black);
-			if (tex) {
-				float w, h; SDL_GetTextureSize(tex, &w, &h);
-				SDL_FRect dst = { 10, 10, w, h };
-				SDL_RenderTexture(renderer, tex, NULL, &dst);
-				SDL_DestroyTexture(tex);
-			}
-		}
-    );
-
-	// Shutdown the engine and clean up resources
-	if (isConnected && netThread.joinable()) netThread.detach();
-    if (hudFont) {
-        TTF_CloseFont(hudFont);
-    }
-    TTF_Quit();
-    Engine::shutdown();
-    return 0;
-}
+﻿#include <SDL3/SDL.h>
+#include <SDL3_image/SDL_image.h>
+#include <SDL3_ttf/SDL_ttf.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Static.h"
+#include "Player.h"
+#include "Auto.h"
+#include "Actions.h"
+
+#include <engine/Engine.h>
+#include <engine/Input.h>
+#include <engine/Physics.h>
+#include <engine/Client.h>
+#include <engine/Timeline.h>
+#include <engine/Tilemap.h>
+#include <engine/Scene.h>
+#include <engine/Assets.h>
+#include <engine/Allocations.h>
+#include <engine/NetworkTypes.h>
+
+
+// HUD font: the pack's pre-rasterized atlas, or the TTF file without a pack
+const AssetFont* hudAtlas = nullptr;
+TTF_Font* hudFont = nullptr;
+
+// Timeline speed levels
+const std::vector<float> speedLevels = { 0.5f, 1.0f, 2.0f };
+size_t currentSpeedIndex = 1;
+
+// Remote player slots reserved at startup, more still work but grow the pool
+const size_t kMaxRemotePlayers = 16;
+
+// Helper function to render text to a texture
+SDL_Texture* renderText(SDL_Renderer* renderer, TTF_Font* font, const char* text, SDL_Color color) {
+    SDL_Surface* surface = TTF_RenderText_Solid(font, text, std::strlen(text), color);
+    if (!surface) return nullptr;
+    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    SDL_DestroySurface(surface);
+    return texture;
+}
+
+// Mutex + snapshot storage, vectors so copying each snapshot in reuses their capacity
+std::mutex stateMutex;
+struct ServerSnapshot {
+	int tick = -1;
+	std::vector<std::pair<int, OrderedPair>> otherPlayersPositions;
+	std::vector<SyncedObjectData> syncedObjects;
+	int myHits = 0; // orb hits the server has counted for this player
+	bool valid = false;
+};
+ServerSnapshot latestSnapshot;
+
+// Bind actions for my game
+void setupInputBindings() {
+	Input::clearBindings();
+
+	// Networked actions
+	Input::bindAction(SDL_SCANCODE_W, 0); // Jump → bit 0
+	Input::bindAction(SDL_SCANCODE_S, 1); // Dodge → bit 1
+	Input::bindAction(SDL_SCANCODE_UP, 2); // Scale up
+	Input::bindAction(SDL_SCANCODE_DOWN, 3); // Scale down
+	Input::bindAction(SDL_SCANCODE_SPACE, 4); // Pause
+}
+
+// The scene record decides physics, whatever the entity class defaults to
+void applySceneFlags(Entity* entity, const SceneEntity& e) {
+	entity->setCollidable((e.flags & SceneEntity::Collidable) != 0);
+	entity->setAffectedByGravity((e.flags & SceneEntity::Gravity) != 0);
+}
+
+// A server with a bandwidth budget only sends what matters most each tick, so update what this
+// snapshot carries and keep the last known state of the rest. Call with stateMutex held.
+void mergePartialSnapshot(const WorldSnapshot& snapshot, int playerID) {
+	for (const SyncedObjectData& obj : snapshot.syncedObjects) {
+		auto it = std::find_if(latestSnapshot.syncedObjects.begin(), latestSnapshot.syncedObjects.end(),
+			[&obj](const SyncedObjectData& known) { return known.id == obj.id; });
+		if (it == latestSnapshot.syncedObjects.end()) latestSnapshot.syncedObjects.push_back(obj);
+		else *it = obj;
+	}
+
+	auto& others = latestSnapshot.otherPlayersPositions;
+	for (size_t i = 0; i < snapshot.playerIds.size(); ++i) {
+		const int id = snapshot.playerIds[i];
+		if (id == playerID) {
+			latestSnapshot.myHits = snapshot.playerHits[i];
+			continue;
+		}
+		auto it = std::find_if(others.begin(), others.end(),
+			[id](const std::pair<int, OrderedPair>& known) { return known.first == id; });
+		if (it == others.end()) others.emplace_back(id, snapshot.playerPositions[i]);
+		else it->second = snapshot.playerPositions[i];
+	}
+
+	// The roster has everyone still in the room
+	others.erase(std::remove_if(others.begin(), others.end(), [&snapshot](const std::pair<int, OrderedPair>& known) {
+		return std::find(snapshot.roster.begin(), snapshot.roster.end(), known.first) == snapshot.roster.end();
+	}), others.end());
+}
+
+// Network thread
+void networkReceiveThread(Client& net, int playerID) {
+	// Decoded into in place. Sized for a full room up front, so a player joining later doesn't grow it.
+	WorldSnapshot snapshot;
+	snapshot.playerIds.reserve(kMaxRemotePlayers + 1);
+	snapshot.playerPositions.reserve(kMaxRemotePlayers + 1);
+	snapshot.playerHits.reserve(kMaxRemotePlayers + 1);
+	snapshot.roster.reserve(kMaxRemotePlayers + 1);
+	{
+		std::lock_guard<std::mutex> lock(stateMutex);
+		latestSnapshot.otherPlayersPositions.reserve(kMaxRemotePlayers);
+	}
+	while (true) {
+		// Sleeps until a snapshot arrives rather than polling every millisecond
+		if (!net.waitForUpdate(snapshot, 100)) {
+			continue;
+		}
+		std::lock_guard<std::mutex> lock(stateMutex);
+		latestSnapshot.tick = snapshot.tick;
+		if (snapshot.partial) {
+			mergePartialSnapshot(snapshot, playerID);
+			latestSnapshot.valid = true;
+			continue;
+		}
+		latestSnapshot.syncedObjects = snapshot.syncedObjects;
+		latestSnapshot.otherPlayersPositions.clear();
+		for (size_t i = 0; i < snapshot.playerIds.size(); ++i) {
+			if (snapshot.playerIds[i] != playerID) {
+				latestSnapshot.otherPlayersPositions.emplace_back(snapshot.playerIds[i], snapshot.playerPositions[i]);
+			}
+			else {
+				latestSnapshot.myHits = snapshot.playerHits[i];
+			}
+		}
+		latestSnapshot.valid = true;
+	}
+}
+
+int main(int argc, char* argv[]) {
+
+    // Ask for a player ID so each client is unique
+    int playerID;
+	std::cout << "Enter player ID (integer): ";
+	std::cin >> playerID;
+
+    // Set clientID with playerID
+	Client::setClientID(playerID);
+
+	// Command line options
+	// --record <log> captures the session, --replay <log> plays one back instead of connecting
+	// --headless runs the simulation without opening a window
+	// --room <id> joins that match on the server (default 0)
+	// --server <address> and --port <n> pick the server (default tcp://localhost 5555), e.g. a netem_proxy
+	// --zero-alloc reports (and asserts in debug) any frame that allocates after the first 10 seconds,
+	// needs a build with ENGINE_TRACK_ALLOCATIONS
+	std::string recordPath, replayPath;
+	bool headless = false;
+	bool zeroAlloc = false;
+	int room = 0;
+	std::string serverAddress = "tcp://localhost";
+	int serverPort = 5555;
+	for (int i = 1; i < argc; ++i) {
+		const std::string arg = argv[i];
+		if (arg == "--record" && i + 1 < argc) recordPath = argv[++i];
+		else if (arg == "--replay" && i + 1 < argc) replayPath = argv[++i];
+		else if (arg == "--headless") headless = true;
+		else if (arg == "--zero-alloc") zeroAlloc = true;
+		else if (arg == "--room" && i + 1 < argc) room = std::atoi(argv[++i]);
+		else if (arg == "--server" && i + 1 < argc) serverAddress = argv[++i];
+		else if (arg == "--port" && i + 1 < argc) serverPort = std::atoi(argv[++i]);
+	}
+
+	// Configure the engine window
+    Engine::Config config;
+	config.title = "CSC 481 Game";
+	config.width = 1900;
+	config.height = 1000;
+	config.headless = headless;
+
+    // Initialize the engine
+    if (!Engine::init(config)) {
+        SDL_Log("Failed to initialize engine: %s", SDL_GetError());
+        return 1;  // Failed to init SDL
+    }
+
+	// Textures and the HUD font come pre-decoded from the asset pack when it was built
+	Assets::openPack("assets/game.pack");
+	hudAtlas = Assets::getFont("hud");
+
+	// TTF initialization, only needed when the pack has no HUD font
+	if (!hudAtlas) {
+		if (!TTF_Init()) {
+			SDL_Log("Failed to init TTF: %s", SDL_GetError());
+			Engine::shutdown();
+			return 1;
+		}
+
+		// Load font for HUD
+		hudFont = TTF_OpenFont("assets/DejaVuSans.ttf", 24);
+		if (!hudFont) {
+			SDL_Log("Failed to load font: %s", SDL_GetError());
+			Engine::shutdown();
+			return 1;
+		}
+	}
+
+	// Setup input bindings (jump + dodge)
+	setupInputBindings();
+
+	// Increase gravity for this session
+	Physics::setGravity(200.0f);
+
+    // Initialize the timeline
+    Timeline timeline;
+    timeline.init();
+
+	// Set initial time scale
+	timeline.setScale(speedLevels[currentSpeedIndex]);
+
+	// Entities updated on the engine thread follow the same clock, so pause and speed apply to them too
+	Engine::setTimeline(&timeline);
+	setupInputBindings();
+
+	// Initialize the client for networking
+	Client net;
+	bool isConnected = false;
+	if (!replayPath.empty()) {
+		isConnected = net.startReplay(replayPath);
+	}
+	else {
+		isConnected = net.connect(serverAddress, room, serverPort);
+		if (isConnected && !recordPath.empty()) net.startRecording(recordPath);
+	}
+
+	// The level comes from its scene file: entities through the kinds registered here,
+	// tiles from the tilemap it names
+	Scene scene;
+	if (!scene.open("assets/level1.scene")) {
+		SDL_Log("Failed to load scene assets/level1.scene");
+		Engine::shutdown();
+		return 1;
+	}
+
+	// The first Player record is the local player
+	Player* localPlayer = nullptr;
+	scene.registerKind("Player", [&](const SceneEntity& e, const char* texture) {
+		if (localPlayer) return;
+		localPlayer = new Player(e.x, e.y, e.w, e.h, texture);
+		applySceneFlags(localPlayer, e);
+		localPlayer->setInputControlled(true); // the update thread hands it each tick's actions
+		Engine::addEntity(localPlayer);
+	});
+	scene.registerKind("Static", [](const SceneEntity& e, const char* texture) {
+		Static* body = new Static(e.x, e.y, e.w, e.h, texture);
+		applySceneFlags(body, e);
+		// Without the static flag it is updated like any entity, e.g. a crate that falls
+		if (e.flags & SceneEntity::Static) Engine::addStaticEntity(body);
+		else Engine::addEntity(body);
+	});
+	scene.instantiate();
+	if (!localPlayer) {
+		SDL_Log("Scene has no Player");
+		Engine::shutdown();
+		return 1;
+	}
+
+	// The camera follows the player and never shows past the level's edges
+	Tilemap level;
+	SDL_FRect worldBounds = { 0.0f, 0.0f, 1920.0f, 1080.0f };
+	if (scene.tilemap() && level.open(scene.tilemap())) {
+		Engine::setTilemap(&level);
+		const SDL_FRect tiles = level.getBounds();
+		worldBounds.w = std::max(worldBounds.w, tiles.w);
+		worldBounds.h = std::max(worldBounds.h, tiles.h);
+	}
+	Engine::getCamera().setBounds(worldBounds);
+
+	// Other players in the game, by network id. Reserved up front so players joining
+	// mid session are placed in the pool without allocating on the frame thread.
+	std::vector<std::pair<int, Handle<Player>>> otherPlayers;
+	otherPlayers.reserve(kMaxRemotePlayers);
+	Engine::reservePool<Player>(kMaxRemotePlayers, "assets/Morwen.png");
+
+	// Auto-moving orb reference
+	Handle<Auto> orb;
+	Engine::reservePool<Auto>(1, "assets/Orb.png");
+
+	// Network receive thread
+	std::thread netThread;
+	if (isConnected) netThread = std::thread(networkReceiveThread, std::ref(net), playerID);
+
+	int currentTick = 0;
+
+	// The server decides orb hits against the snapshot we had on screen, so we report which one
+	// that was and respawn when its count of our hits goes up
+	int seenTick = -1;
+	int appliedHits = -1;
+	if (isConnected && !net.isReplaying()) localPlayer->setServerHits(true);
+
+	// Loading, first spawns and pool growth are done well within the warm up
+	if (zeroAlloc) {
+		if (!Allocations::isTracking()) SDL_Log("--zero-alloc needs a build with ENGINE_TRACK_ALLOCATIONS");
+		Allocations::setSteadyStateAfter(600);
+	}
+
+    // Main game loop
+    Engine::run(
+        [&](float rawDelta) {
+
+			// What the update ticks since last frame sampled, edges from every tick included
+			const ActionSample input = Engine::takeActions();
+			const uint32_t actionMask = input.active();
+            
+            // Speed up with up arrow
+			if ((input.pressed & ACTION_SCALE_UP) && currentSpeedIndex < speedLevels.size() - 1) {
+				timeline.setScale(speedLevels[++currentSpeedIndex]);
+			}
+
+			// Slow down with down arrow
+			if ((input.pressed & ACTION_SCALE_DOWN) && currentSpeedIndex > 0) {
+				timeline.setScale(speedLevels[--currentSpeedIndex]);
+			}
+
+			// Handle pausing with Space
+			if (input.pressed & ACTION_PAUSE) {
+				if (timeline.isPaused()) {
+					timeline.resume();
+					localPlayer->setPaused(false);
+				}
+				else {
+					timeline.pause();
+					localPlayer->setPaused(true);
+				}
+			}
+
+            // Update the scaled timeline
+            timeline.update();
+			currentTick++;
+
+			if (timeline.isPaused()) {
+				return; // Skip all updates while paused
+			}
+
+			// Keep the player in the middle of the view, the tilemap streams around it
+			{
+				const SDL_FRect r = localPlayer->getRect();
+				Engine::getCamera().setCenter({ r.x + r.w * 0.5f, r.y + r.h * 0.5f });
+			}
+
+			// Apply latest snapshot to orb + other players
+			{
+				std::lock_guard<std::mutex> lock(stateMutex);
+				if (latestSnapshot.valid) {
+					if (appliedHits >= 0 && latestSnapshot.myHits > appliedHits) localPlayer->requestRespawn();
+					appliedHits = latestSnapshot.myHits;
+					seenTick = latestSnapshot.tick;
+
+					for (const auto& obj : latestSnapshot.syncedObjects) {
+						if (obj.id == 1 && obj.type == 1) { // Orb
+							if (Auto* o = Engine::get(orb)) {
+								o->setPosition(obj.position);
+							}
+							else {
+								orb = Engine::spawn<Auto>(obj.position.x, obj.position.y, 128.0f, 128.0f, "assets/Orb.png");
+								Engine::get(orb)->setServerControlled(true);
+							}
+						}
+					}
+					for (auto& [id, pos] : latestSnapshot.otherPlayersPositions) {
+						auto it = std::find_if(otherPlayers.begin(), otherPlayers.end(),
+							[id = id](const std::pair<int, Handle<Player>>& p) { return p.first == id; });
+						if (it == otherPlayers.end()) {
+							otherPlayers.emplace_back(id, Engine::spawn<Player>(pos.x, pos.y, 64.0f, 64.0f, "assets/Morwen.png"));
+						}
+						else if (Player* p = Engine::get(it->second)) {
+							p->setPosition(pos);
+						}
+					}
+
+					// Despawn players the server no longer reports
+					for (size_t i = 0; i < otherPlayers.size();) {
+						const int id = otherPlayers[i].first;
+						auto reported = std::find_if(latestSnapshot.otherPlayersPositions.begin(), latestSnapshot.otherPlayersPositions.end(),
+							[id](const std::pair<int, OrderedPair>& p) { return p.first == id; });
+						if (reported == latestSnapshot.otherPlayersPositions.end()) {
+							Engine::despawn(otherPlayers[i].second);
+							otherPlayers[i] = otherPlayers.back();
+							otherPlayers.pop_back();
+						}
+						else {
+							++i;
+						}
+					}
+				}
+			}
+
+			// Send player state to server
+			if (isConnected) {
+				ClientCommand cmd{ playerID, actionMask, currentTick,
+								  localPlayer->getPosition().x, localPlayer->getPosition().y };
+				cmd.seenTick = seenTick;
+				net.sendCommand(cmd);
+			}
+        },
+        [&]() {
+			SDL_Renderer* renderer = Engine::getRenderer();
+			SDL_Color black = { 0,0,0,255 };
+			// Formatted on the stack, the HUD is drawn every frame
+			char hud[96];
+			std::snprintf(hud, sizeof(hud), "Client ID: %d | Speed: x%g%s", playerID, timeline.getScale(),
+				timeline.isPaused() ? " [PAUSED]" : "");
+			if (hudAtlas) {
+				Assets::drawText(renderer, hudAtlas, hud, 10, 10, black);
+				return;
+			}
+			SDL_Texture* tex = renderText(renderer, hudFont, hud, black);
+			if (tex) {
+				float w, h; SDL_GetTextureSize(tex, &w, &h);
+				SDL_FRect dst = { 10, 10, w, h };
+				SDL_RenderTexture(renderer, tex, NULL, &dst);
+				SDL_DestroyTexture(tex);
+			}
+		}
+    );
+
+	// Shutdown the engine and clean up resources
+	if (isConnected && netThread.joinable()) netThread.detach();
+    if (hudFont) {
+        TTF_CloseFont(hudFont);
+        TTF_Quit();
+    }
+    Engine::shutdown();
+    return 0;
+}